@@ -0,0 +1,354 @@
+#include "abstract_code.hpp"
+#include "arena.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <sys/resource.h>
+
+/**
+ *  Measures building and releasing of randomly generated translation units.
+ *  Each unit is generated from its own seed, so that all runs, and runs
+ *  of different versions of the tree built by the same compiler, build
+ *  the same units.
+ *
+ *  Usage: arena-bench [unit count] [rounds]
+ */
+
+namespace
+{
+    using namespace fri;
+
+    /**
+     *  @brief Generates random classes with bodies of various shapes
+     *  into an arena.
+     */
+    class UnitGenerator
+    {
+    public:
+        UnitGenerator (unsigned seed, Arena& arena);
+
+        auto unit_classes () -> std::vector<Class*>;
+
+    private:
+        auto pick      (int n) -> int;
+        auto name      () -> Symbol;
+        auto type      () -> Type*;
+        auto args      (int max) -> args_t;
+        auto params    (int max) -> params_t;
+        auto expr      () -> Expression*;
+        auto body      (int count) -> CompoundStatement;
+        auto statement () -> Statement*;
+        auto make_class () -> Class*;
+
+    private:
+        std::mt19937 random_;
+        Arena*       arena_;
+        int          depth_;
+    };
+
+    UnitGenerator::UnitGenerator
+        (unsigned const seed, Arena& arena) :
+        random_ (seed),
+        arena_  (&arena),
+        depth_  (0)
+    {
+    }
+
+    auto UnitGenerator::unit_classes
+        () -> std::vector<Class*>
+    {
+        auto classes = std::vector<Class*>();
+        auto const count = 1 + this->pick(2);
+        for (auto i = 0; i < count; ++i)
+        {
+            classes.push_back(this->make_class());
+        }
+        return classes;
+    }
+
+    auto UnitGenerator::pick
+        (int const n) -> int
+    {
+        return static_cast<int>(random_() % static_cast<unsigned>(n));
+    }
+
+    auto UnitGenerator::name
+        () -> Symbol
+    {
+        static char const* const names[] =
+        {
+            "i", "x", "count", "someVeryLongVariableName",
+            "anotherQuiteLongIdentifierHere", "data_", "k", "aLongishName"
+        };
+        return arena_->intern(names[this->pick(8)]);
+    }
+
+    auto UnitGenerator::type
+        () -> Type*
+    {
+        auto& a = *arena_;
+        switch (this->pick(6))
+        {
+            case 0:
+                return a.make<PrimType>(this->pick(2) != 0, a.intern(this->pick(2) ? "int" : "size_t"));
+
+            case 1:
+                return a.make<CustomType>(this->pick(2) != 0, a.intern(this->pick(2) ? "Zoznam" : "VeryLongCustomTypeNameForTesting"));
+
+            case 2:
+            {
+                auto as = std::vector<TemplatedType::arg_var_t>();
+                as.emplace_back(this->type());
+                if (this->pick(2))
+                {
+                    as.emplace_back(this->type());
+                }
+                return a.make<TemplatedType>(false, a.make<CustomType>(false, a.intern("Tabulka")), std::move(as));
+            }
+
+            case 3:
+                return a.make<Indirection>(false, this->pick(3) ? this->type() : a.make<PrimType>(false, a.intern("void")));
+
+            default:
+                return a.make<PrimType>(false, a.intern("double"));
+        }
+    }
+
+    auto UnitGenerator::args
+        (int const max) -> args_t
+    {
+        auto as = args_t();
+        auto const count = this->pick(max + 1);
+        for (auto i = 0; i < count; ++i)
+        {
+            as.push_back(this->expr());
+        }
+        return as;
+    }
+
+    auto UnitGenerator::params
+        (int const max) -> params_t
+    {
+        auto ps = params_t();
+        auto const count = this->pick(max + 1);
+        for (auto i = 0; i < count; ++i)
+        {
+            if (this->pick(4) == 0 and depth_ < 4)
+            {
+                ps.emplace_back(this->type(), this->name(), this->expr());
+            }
+            else
+            {
+                ps.emplace_back(this->type(), this->name());
+            }
+        }
+        return ps;
+    }
+
+    auto UnitGenerator::expr
+        () -> Expression*
+    {
+        auto& a = *arena_;
+        auto e  = static_cast<Expression*>(nullptr);
+        ++depth_;
+        switch (depth_ > 5 ? this->pick(3) : this->pick(14))
+        {
+            case 0:  e = a.make<IntLiteral>(this->pick(100000)); break;
+            case 1:  e = a.make<VarRef>(this->name()); break;
+            case 2:  e = a.make<StringLiteral>(a.intern("some string literal")); break;
+            case 3:  e = a.make<BinaryOperator>(this->expr(), static_cast<BinOpcode>(this->pick(19)), this->expr()); break;
+            case 4:  e = a.make<FunctionCall>(this->name(), this->args(4)); break;
+            case 5:  e = a.make<MemberFunctionCall>(this->pick(2) ? a.make<This>() : this->expr(), this->name(), this->args(3)); break;
+            case 6:  e = a.make<IfExpression>(this->expr(), this->expr(), this->expr()); break;
+            case 7:  e = a.make<Lambda>(this->params(3), this->body(this->pick(3))); break;
+            case 8:  e = a.make<Parenthesis>(this->expr()); break;
+            case 9:  e = a.make<OperatorChain>(BinOpcode::Add, args_t {this->expr(), this->expr(), this->expr()}); break;
+            case 10: e = a.make<New>(this->type(), this->args(2)); break;
+            case 11: e = a.make<ConstructorCall>(this->type(), this->args(3)); break;
+            case 12: e = a.make<UnaryOperator>(static_cast<UnOpcode>(this->pick(8)), this->expr()); break;
+            default: e = a.make<MemberVarRef>(this->expr(), this->name()); break;
+        }
+        --depth_;
+        return e;
+    }
+
+    auto UnitGenerator::body
+        (int const count) -> CompoundStatement
+    {
+        auto statements = std::vector<Statement*>();
+        for (auto i = 0; i < count; ++i)
+        {
+            statements.push_back(this->statement());
+        }
+        return CompoundStatement(std::move(statements));
+    }
+
+    auto UnitGenerator::statement
+        () -> Statement*
+    {
+        auto& a = *arena_;
+        auto s  = static_cast<Statement*>(nullptr);
+        ++depth_;
+        switch (depth_ > 6 ? this->pick(2) : this->pick(9))
+        {
+            case 0:
+                s = a.make<VarDefinition>(this->type(), this->name(), this->expr());
+                break;
+
+            case 1:
+                s = a.make<ExpressionStatement>(this->expr());
+                break;
+
+            case 2:
+                s = a.make<Return>(this->expr());
+                break;
+
+            case 3:
+                s = this->pick(2)
+                    ? a.make<If>(this->expr(), this->body(this->pick(3)), this->body(this->pick(2)))
+                    : a.make<If>(this->expr(), this->body(this->pick(3)));
+                break;
+
+            case 4:
+                s = a.make<ForLoop>( a.make<VarDefinition>(this->type(), this->name(), this->expr())
+                                   , a.make<BinaryOperator>(this->expr(), BinOpcode::LT, this->expr())
+                                   , this->expr()
+                                   , this->body(this->pick(3)) );
+                break;
+
+            case 5:
+                s = a.make<WhileLoop>(this->expr(), this->body(this->pick(3)));
+                break;
+
+            case 6:
+            {
+                auto cases = std::vector<Case>();
+                auto const count = this->pick(3);
+                for (auto i = 0; i < count; ++i)
+                {
+                    cases.emplace_back(this->expr(), this->body(this->pick(2)));
+                }
+                s = a.make<Switch>(this->expr(), std::move(cases), this->body(1));
+                break;
+            }
+
+            case 7:
+                s = a.make<VarDefinition>(this->type(), this->name());
+                break;
+
+            default:
+                s = a.make<DoWhileLoop>(this->expr(), this->body(this->pick(3)));
+                break;
+        }
+        --depth_;
+        return s;
+    }
+
+    auto UnitGenerator::make_class
+        () -> Class*
+    {
+        auto const c = arena_->make<Class>("ns::C");
+        c->name_ = this->pick(2) ? "C" : "AVeryLongClassNameThatTakesSpace";
+        if (this->pick(2))
+        {
+            c->templateParams_ = {"T", "U"};
+        }
+        if (this->pick(3) == 0)
+        {
+            c->alias_ = "Al";
+        }
+        if (this->pick(2))
+        {
+            c->bases_.push_back(this->type());
+        }
+
+        auto const methodCount = 1 + this->pick(4);
+        for (auto i = 0; i < methodCount; ++i)
+        {
+            c->methods_.emplace_back(this->name(), this->type(), this->params(6), this->body(this->pick(5)));
+        }
+
+        auto const constructorCount = this->pick(3);
+        for (auto i = 0; i < constructorCount; ++i)
+        {
+            auto memberInits = std::vector<MemberInitPair>();
+            if (this->pick(2))
+            {
+                memberInits.emplace_back(this->name(), this->args(2));
+            }
+            c->constructors_.emplace_back(this->params(5), std::vector<BaseInitPair>(), std::move(memberInits), this->body(this->pick(3)));
+        }
+
+        auto const fieldCount = this->pick(3);
+        for (auto i = 0; i < fieldCount; ++i)
+        {
+            c->fields_.emplace_back(this->type(), this->name(), this->pick(2) ? this->expr() : nullptr);
+        }
+        return c;
+    }
+
+    /**
+     *  @brief Peak resident set size of the process in KiB.
+     */
+    auto peak_rss
+        () -> long
+    {
+        auto usage = rusage {};
+        ::getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    auto const count  = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 2000u;
+    auto const rounds = argc > 2 ? std::atoi(argv[2]) : 7;
+    auto const ms     = [](auto const from, auto const to)
+    {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    };
+
+    auto const baseRss = peak_rss();
+    auto bestBuild     = 1e9;
+    auto bestFree      = 1e9;
+    auto nodeBytes     = std::size_t {0};
+    for (auto round = 0; round < rounds; ++round)
+    {
+        auto const start = std::chrono::steady_clock::now();
+        auto units = std::vector<TranslationUnit>();
+        units.reserve(count);
+        for (auto seed = 0u; seed < count; ++seed)
+        {
+            auto arena     = std::make_unique<Arena>();
+            auto generator = UnitGenerator(seed, *arena);
+            auto classes   = generator.unit_classes();
+            units.emplace_back(std::move(arena), std::move(classes));
+        }
+        auto const built = std::chrono::steady_clock::now();
+
+        nodeBytes = 0;
+        for (auto const& unit : units)
+        {
+            nodeBytes += unit.get_arena().reserved();
+        }
+
+        units.clear();
+        units.shrink_to_fit();
+        auto const freed = std::chrono::steady_clock::now();
+
+        bestBuild = std::min(bestBuild, ms(start, built));
+        bestFree  = std::min(bestFree, ms(built, freed));
+    }
+
+    std::cout << "Units:         " << count << " (best of " << rounds << " rounds)" << '\n'
+              << "Build:         " << bestBuild << " ms" << '\n'
+              << "Free:          " << bestFree << " ms" << '\n'
+              << "Arena chunks:  " << nodeBytes / 1024 << " KiB" << '\n'
+              << "Peak RSS:      " << peak_rss() - baseRss << " KiB" << '\n';
+}
@@ -1,9 +1,94 @@
 #include "abstract_code.hpp"
 
 #include <algorithm>
+#include <variant>
 
 namespace fri
 {
+    namespace
+    {
+        /**
+         *  @brief Finds by how much @p inc changes @p counter .
+         */
+        auto find_step
+            (Expression const* const inc, VarDefCommon const* const counter) -> std::int8_t
+        {
+            auto const u   = dyn_cast<UnaryOperator>(inc);
+            auto const arg = u ? std::get_if<Expression*>(&u->arg_) : nullptr;
+            auto const ref = arg ? dyn_cast<VarRef>(*arg) : nullptr;
+            if (not counter or not ref or not (ref->name_ == counter->name_))
+            {
+                return 0;
+            }
+
+            switch (u->op_)
+            {
+                case UnOpcode::IncPre:
+                case UnOpcode::IncPost: return 1;
+                case UnOpcode::DecPre:
+                case UnOpcode::DecPost: return -1;
+                default:                return 0;
+            }
+        }
+
+        /**
+         *  @brief Finds comparison in condition @p cond that bounds
+         *  @p counter changed by @p step .
+         */
+        auto find_bound
+            (Expression const* const cond, VarDefCommon const* const counter, std::int8_t const step) -> BinaryOperator const*
+        {
+            auto const b   = dyn_cast<BinaryOperator>(cond);
+            auto const ref = b ? dyn_cast<VarRef>(b->lhs_) : nullptr;
+            if (not counter or not ref or not (ref->name_ == counter->name_))
+            {
+                return nullptr;
+            }
+
+            switch (b->op_)
+            {
+                case BinOpcode::LT:
+                case BinOpcode::LE: return step > 0 ? b : nullptr;
+                case BinOpcode::GT:
+                case BinOpcode::GE: return step < 0 ? b : nullptr;
+                default:            return nullptr;
+            }
+        }
+
+        auto find_shape
+            (Statement const* const var, Expression const* const cond, Expression const* const inc) -> LoopShape
+        {
+            auto const def     = dyn_cast<VarDefinition>(var);
+            auto const counter = def ? &def->var_ : nullptr;
+            auto const step    = find_step(inc, counter);
+            auto const bound   = find_bound(cond, counter, step);
+            return LoopShape
+                { .counter_ = counter
+                , .from_    = counter ? counter->initializer_ : nullptr
+                , .to_      = bound ? bound->rhs_ : nullptr
+                , .step_    = step
+                , .toIncl_  = bound and (bound->op_ == BinOpcode::LE or bound->op_ == BinOpcode::GE) };
+        }
+    }
+
+    Expression::Expression
+        (NodeKind const kind) :
+        kind_ (kind)
+    {
+    }
+
+    Statement::Statement
+        (NodeKind const kind) :
+        kind_ (kind)
+    {
+    }
+
+    Type::Type
+        (NodeKind const kind) :
+        kind_ (kind)
+    {
+    }
+
     IsConst::IsConst
         (bool const is) :
         is_ {is}
@@ -31,34 +116,34 @@ namespace fri
     }
 
     PrimType::PrimType
-        (IsConst const is, std::string name) :
+        (IsConst const is, Symbol const name) :
         CommonType<PrimType> (is),
-        name_ (std::move(name))
+        name_ (name)
     {
     }
 
     auto PrimType::to_string
         () const -> std::string
     {
-        return name_;
+        return name_.str();
     }
 
     CustomType::CustomType
-        (IsConst const is, std::string name) :
+        (IsConst const is, Symbol const name) :
         CommonType<CustomType> (is),
-        name_ (std::move(name))
+        name_ (name)
     {
     }
 
     auto CustomType::to_string
         () const -> std::string
     {
-        return name_;
+        return name_.str();
     }
 
     TemplatedType::TemplatedType
-        ( IsConst const is
-        , uptr<Type>             b
+        ( IsConst const          is
+        , Type*                  b
         , std::vector<arg_var_t> as ) :
         CommonType<TemplatedType> (is),
         base_ (std::move(b)),
@@ -93,7 +178,7 @@ namespace fri
     }
 
     Indirection::Indirection
-        (IsConst const is, uptr<Type> pointee) :
+        (IsConst const is, Type* pointee) :
         CommonType<Indirection> (is),
         pointee_ (std::move(pointee))
     {
@@ -106,8 +191,8 @@ namespace fri
     }
 
     Function::Function
-        ( std::vector<uptr<Type>> ps
-        , uptr<Type>              r ) :
+        ( std::vector<Type*> ps
+        , Type*              r ) :
         CommonType<Function> (IsConst(false)),
         params_ (std::move(ps)),
         ret_    (std::move(r))
@@ -135,12 +220,12 @@ namespace fri
     }
 
     Nested::Nested
-        ( IsConst     c
-        , uptr<Type>  t
-        , std::string n ) :
+        ( IsConst c
+        , Type*   t
+        , Symbol  n ) :
         CommonType<Nested> (c),
         nest_ (std::move(t)),
-        name_ (std::move(n))
+        name_ (n)
     {
     }
 
@@ -148,58 +233,58 @@ namespace fri
         () const -> std::string
     {
         auto ret = nest_->to_string();
-        (ret += ".") += name_;
+        (ret += ".") += name_.view();
         return ret;
     }
 
     VarDefCommon::VarDefCommon
-        (uptr<Type> t, std::string n) :
+        (Type* t, Symbol n) :
         type_        (std::move(t)),
-        name_        (std::move(n))
+        name_        (n)
     {
     }
 
     VarDefCommon::VarDefCommon
-        (uptr<Type> t, std::string n, uptr<Expression> i) :
+        (Type* t, Symbol n, Expression* i) :
         type_        (std::move(t)),
-        name_        (std::move(n)),
+        name_        (n),
         initializer_ (std::move(i))
     {
     }
 
     ParamDefinition::ParamDefinition
-        (uptr<Type> t, std::string n) :
-        var_ (std::move(t), std::move(n))
+        (Type* t, Symbol n) :
+        var_ (std::move(t), n)
     {
     }
 
     ParamDefinition::ParamDefinition
-        (uptr<Type> t, std::string n, uptr<Expression> i) :
-        var_ (std::move(t), std::move(n), std::move(i))
+        (Type* t, Symbol n, Expression* i) :
+        var_ (std::move(t), n, std::move(i))
     {
     }
 
     FieldDefinition::FieldDefinition
-        (uptr<Type> t, std::string n) :
-        var_ (std::move(t), std::move(n))
+        (Type* t, Symbol n) :
+        var_ (std::move(t), n)
     {
     }
 
     FieldDefinition::FieldDefinition
-        (uptr<Type> t, std::string n, uptr<Expression> i) :
-        var_ (std::move(t), std::move(n), std::move(i))
+        (Type* t, Symbol n, Expression* i) :
+        var_ (std::move(t), n, std::move(i))
     {
     }
 
     VarDefinition::VarDefinition
-        (uptr<Type> t, std::string n) :
-        var_ (std::move(t), std::move(n))
+        (Type* t, Symbol n) :
+        var_ (std::move(t), n)
     {
     }
 
     VarDefinition::VarDefinition
-        (uptr<Type> t, std::string n, uptr<Expression> i) :
-        var_ (std::move(t), std::move(n), std::move(i))
+        (Type* t, Symbol n, Expression* i) :
+        var_ (std::move(t), n, std::move(i))
     {
     }
 
@@ -222,131 +307,152 @@ namespace fri
     }
 
     StringLiteral::StringLiteral
-        (std::string str) :
-        str_ (std::move(str))
+        (Symbol const str) :
+        str_ (str)
     {
     }
 
     BinaryOperator::BinaryOperator
-        ( uptr<Expression> lhs
-        , BinOpcode                   op
-        , uptr<Expression> rhs ) :
+        ( Expression* lhs
+        , BinOpcode   op
+        , Expression* rhs ) :
         op_  (op),
         lhs_ (std::move(lhs)),
         rhs_ (std::move(rhs))
     {
     }
 
+    OperatorChain::OperatorChain
+        ( BinOpcode op
+        , args_t    os ) :
+        op_       (op),
+        operands_ (std::move(os))
+    {
+    }
+
+    auto is_associative
+        (BinOpcode const op) -> bool
+    {
+        switch (op)
+        {
+            case BinOpcode::Add:
+            case BinOpcode::Mul:
+            case BinOpcode::And:
+            case BinOpcode::Or: return true;
+            default:            return false;
+        }
+    }
+
     UnaryOperator::UnaryOperator
-        ( UnOpcode                    o
-        , uptr<Expression> a) :
+        ( UnOpcode    o
+        , Expression* a) :
         op_  (o),
         arg_ (std::move(a))
     {
     }
 
     UnaryOperator::UnaryOperator
-        ( UnOpcode              o
-        , uptr<Type> a ) :
+        ( UnOpcode o
+        , Type*    a ) :
         op_  (o),
         arg_ (std::move(a))
     {
     }
 
     Parenthesis::Parenthesis
-        (uptr<Expression> expression) :
+        (Expression* expression) :
         expression_ (std::move(expression))
     {
     }
 
     VarRef::VarRef
-        (std::string name) :
-        name_ (std::move(name))
+        (Symbol const name) :
+        name_ (name)
     {
     }
 
     MemberVarRef::MemberVarRef
-        ( uptr<Expression> b
-        , std::string n ) :
+        ( Expression* b
+        , Symbol      n ) :
         base_ (std::move(b)),
-        name_ (std::move(n))
+        name_ (n)
     {
     }
 
     New::New
-        ( uptr<Type> t
-        , std::vector<uptr<Expression>> as ) :
+        ( Type*  t
+        , args_t as ) :
         type_ (std::move(t)),
         args_ (std::move(as))
     {
     }
 
     FunctionCall::FunctionCall
-        ( std::string n
-        , std::vector<uptr<Expression>> as ) :
-        name_ (std::move(n)),
+        ( Symbol n
+        , args_t as ) :
+        name_ (n),
         args_ (std::move(as))
     {
     }
 
     ConstructorCall::ConstructorCall
-        ( uptr<Type>                    t
-        , std::vector<uptr<Expression>> as ) :
+        ( Type*  t
+        , args_t as ) :
         type_ (std::move(t)),
         args_ (std::move(as))
     {
     }
 
     DestructorCall::DestructorCall
-        (uptr<Expression> e) :
+        (Expression* e) :
         ex_ (std::move(e))
     {
     }
 
     MemberFunctionCall::MemberFunctionCall
-        ( uptr<Expression>              e
-        , std::string                              c
-        , std::vector<uptr<Expression>> as ) :
+        ( Expression* e
+        , Symbol      c
+        , args_t      as ) :
         base_ (std::move(e)),
-        call_ (std::move(c)),
+        call_ (c),
         args_ (std::move(as))
     {
     }
 
     ExpressionCall::ExpressionCall
-        ( uptr<Expression>              e
-        , std::vector<uptr<Expression>> as ) :
+        ( Expression* e
+        , args_t      as ) :
         ex_   (std::move(e)),
         args_ (std::move(as))
     {
     }
 
     Delete::Delete
-        (uptr<Expression> ex) :
+        (Expression* ex) :
         ex_ (std::move(ex))
     {
     }
 
     CompoundStatement::CompoundStatement
-        (uptr<Statement> s)
+        (Statement* s)
     {
         statements_.emplace_back(std::move(s));
     }
 
     CompoundStatement::CompoundStatement
-        (std::vector<uptr<Statement>> ss) :
+        (std::vector<Statement*> ss) :
         statements_ (std::move(ss))
     {
     }
 
     Return::Return
-        (uptr<Expression> e) :
+        (Expression* e) :
         expression_ (std::move(e))
     {
     }
 
     If::If
-        ( uptr<Expression> c
+        ( Expression*       c
         , CompoundStatement t ) :
         condition_ (std::move(c)),
         then_      (std::move(t))
@@ -354,7 +460,7 @@ namespace fri
     }
 
     If::If
-        ( uptr<Expression> c
+        ( Expression*       c
         , CompoundStatement t
         , CompoundStatement e) :
         condition_ (std::move(c)),
@@ -364,9 +470,9 @@ namespace fri
     }
 
     IfExpression::IfExpression
-        ( uptr<Expression> c
-        , uptr<Expression> t
-        , uptr<Expression> e ) :
+        ( Expression* c
+        , Expression* t
+        , Expression* e ) :
         cond_ (std::move(c)),
         then_ (std::move(t)),
         else_ (std::move(e))
@@ -374,39 +480,40 @@ namespace fri
     }
 
     ExpressionStatement::ExpressionStatement
-        (uptr<Expression> expression) :
+        (Expression* expression) :
         expression_ (std::move(expression))
     {
     }
 
     ForLoop::ForLoop
-        ( uptr<Statement>  var
-        , uptr<Expression> cond
-        , uptr<Expression> inc
-        , CompoundStatement           b ) :
-        var_  (std::move(var)),
-        cond_ (std::move(cond)),
-        inc_  (std::move(inc)),
-        body_ (std::move(b))
+        ( Statement*        var
+        , Expression*       cond
+        , Expression*       inc
+        , CompoundStatement b ) :
+        var_   (std::move(var)),
+        cond_  (std::move(cond)),
+        inc_   (std::move(inc)),
+        body_  (std::move(b)),
+        shape_ (find_shape(var_, cond_, inc_))
     {
     }
 
     WhileLoop::WhileLoop
-        ( uptr<Expression> c
-        , CompoundStatement           b ) :
+        ( Expression*       c
+        , CompoundStatement b ) :
         loop_ {std::move(c), std::move(b)}
     {
     }
 
     DoWhileLoop::DoWhileLoop
-        ( uptr<Expression> c
-        , CompoundStatement           b ) :
+        ( Expression*       c
+        , CompoundStatement b ) :
         loop_ {std::move(c), std::move(b)}
     {
     }
 
     Case::Case
-        ( uptr<Expression>  c
+        ( Expression*       c
         , CompoundStatement b ) :
         expr_ (std::move(c)),
         body_ (std::move(b))
@@ -414,7 +521,7 @@ namespace fri
     }
 
     Switch::Switch
-        ( uptr<Expression>  c
+        ( Expression*       c
         , std::vector<Case> bs ) :
         cond_  (std::move(c)),
         cases_ (std::move(bs))
@@ -422,7 +529,7 @@ namespace fri
     }
 
     Switch::Switch
-        ( uptr<Expression>  c
+        ( Expression*       c
         , std::vector<Case> bs
         , CompoundStatement d ) :
         cond_    (std::move(c)),
@@ -432,31 +539,31 @@ namespace fri
     }
 
     Lambda::Lambda
-        ( std::vector<ParamDefinition> ps
-        , CompoundStatement            b ) :
+        ( params_t          ps
+        , CompoundStatement b ) :
         params_ (std::move(ps)),
         body_   (std::move(b))
     {
     }
 
     BaseInitPair::BaseInitPair
-        ( uptr<Type>                    t
-        , std::vector<uptr<Expression>> es ) :
+        ( Type*  t
+        , args_t es ) :
         base_ (std::move(t)),
         init_ (std::move(es))
     {
     }
 
     MemberInitPair::MemberInitPair
-        ( std::string                              n
-        , std::vector<uptr<Expression>> es ) :
-        name_ (std::move(n)),
+        ( Symbol n
+        , args_t es ) :
+        name_ (n),
         init_ (std::move(es))
     {
     }
 
     Constructor::Constructor
-        ( std::vector<ParamDefinition>     ps
+        ( params_t                         ps
         , std::vector<BaseInitPair>        bis
         , std::vector<MemberInitPair>      is
         , std::optional<CompoundStatement> b ) :
@@ -474,11 +581,11 @@ namespace fri
     }
 
     Method::Method
-        ( std::string n
-        , uptr<Type> ret
-        , std::vector<ParamDefinition> ps
+        ( Symbol                           n
+        , Type*                            ret
+        , params_t                         ps
         , std::optional<CompoundStatement> b ) :
-        name_    (std::move(n)),
+        name_    (n),
         retType_ (std::move(ret)),
         params_  (std::move(ps)),
         body_    (std::move(b))
@@ -486,9 +593,9 @@ namespace fri
     }
 
     AliasDecl::AliasDecl
-        (uptr<Type> t, std::string a) :
-        type_ (std::move(t)),
-        alias_ (std::move(a))
+        (Type* t, Symbol const a) :
+        type_  (std::move(t)),
+        alias_ (a)
     {
     }
 
@@ -504,46 +611,32 @@ namespace fri
         return name_;
     }
 
-    namespace
-    {
-        constexpr auto Interfaces = { "AbstraktnýPamäťovýTyp"
-                                    , "Tabuľka"
-                                    , "Zásobník"
-                                    , "Front"
-                                    , "PrioritnýFront"
-                                    , "Zoznam"
-                                    , "Pole" };
-
-        auto is_interface (std::string_view const name) -> bool
-        {
-            auto const arrowIt = std::ranges::find(name, '<');
-            auto const pos     = std::distance(std::begin(name), arrowIt);
-            auto const prefix  = arrowIt == std::end(name)
-                ? name
-                : name.substr(0, static_cast<std::size_t>(pos));
-            return std::ranges::find(Interfaces, prefix) != std::end(Interfaces);
-        }
-    }
-
     auto is_interface (Class const& c) -> bool
     {
-        return is_interface(std::string_view(c.name()));
+        return c.isInterface_;
     }
 
     auto is_interface (Type const& t) -> bool
     {
-        return is_interface(std::string_view(t.to_string()));
+        return t.isInterface_;
     }
 
     TranslationUnit::TranslationUnit
-        (std::vector<uptr<Class>> classes) :
+        (std::unique_ptr<Arena> arena, std::vector<Class*> classes) :
+        arena_   (std::move(arena)),
         classes_ (std::move(classes))
     {
     }
 
     auto TranslationUnit::get_classes
-        () const -> std::vector<uptr<Class>> const&
+        () const -> std::vector<Class*> const&
     {
         return classes_;
     }
+
+    auto TranslationUnit::get_arena
+        () const -> Arena const&
+    {
+        return *arena_;
+    }
 }
\ No newline at end of file
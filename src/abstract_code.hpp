@@ -9,6 +9,8 @@
 #include <variant>
 #include <type_traits>
 
+#include "arena.hpp"
+#include "small_vector.hpp"
 #include "types.hpp"
 #include "utils.hpp"
 
@@ -16,24 +18,60 @@ namespace fri
 {
     class CodeVisitor;
 
+    /**
+     *  @brief Kind of expression, statement or type node. Stored in the node,
+     *  so that its kind can be checked without a visitor.
+     */
+    enum class NodeKind : std::uint8_t
+    {
+        IntLiteral, FloatLiteral, StringLiteral, NullLiteral, BoolLiteral,
+        BinaryOperator, OperatorChain, UnaryOperator, Parenthesis, VarRef, MemberVarRef,
+        New, FunctionCall, ConstructorCall, DestructorCall, MemberFunctionCall,
+        ExpressionCall, This, IfExpression, Lambda,
+
+        PrimType, CustomType, TemplatedType, Indirection, Function, Nested,
+
+        Delete, VarDefinition, CompoundStatement, Return, If, ExpressionStatement,
+        ForLoop, WhileLoop, DoWhileLoop, Break, Case, Switch, Throw
+    };
+
+    // Nodes are owned by the arena of their translation unit and refer
+    // to each other by plain pointers. They are never deleted through a base,
+    // so that nodes without strings or vectors need no destructor.
+
     struct Expression
     {
-        virtual ~Expression () = default;
+        NodeKind kind_;
         virtual auto accept (CodeVisitor&) const -> void = 0;
+
+    protected:
+        explicit Expression (NodeKind);
+        ~Expression () = default;
     };
 
     struct Statement
     {
-        virtual ~Statement () = default;
+        NodeKind kind_;
         virtual auto accept (CodeVisitor&) const -> void = 0;
+
+    protected:
+        explicit Statement (NodeKind);
+        ~Statement () = default;
     };
 
     struct Type
     {
-        virtual ~Type () = default;
+        NodeKind kind_;
+        bool     isInterface_   {false};
+        bool     isVoid_        {false};
+        bool     isStdFunction_ {false};
         virtual auto accept (CodeVisitor&) const -> void = 0;
         virtual auto to_string () const -> std::string = 0;
         virtual auto is_const  () const -> bool = 0;
+
+    protected:
+        explicit Type (NodeKind);
+        ~Type () = default;
     };
 
     /**
@@ -46,11 +84,13 @@ namespace fri
     };
 
     /**
-     *  @brief Implements accept using CRTP. Makes derived classe a @p VirtualBase .
+     *  @brief Implements accept using CRTP. Makes derived classe a @p VirtualBase
+     *  of kind @c Derived::Kind .
      */
     template<class VirtualBase, class Derived>
     struct VisitableFamily : public VirtualBase
     {
+        VisitableFamily ();
         auto accept (CodeVisitor&) const -> void override;
     };
 
@@ -73,47 +113,53 @@ namespace fri
 
     struct PrimType : public CommonType<PrimType>
     {
-        std::string name_;
-        PrimType (IsConst, std::string);
+        static constexpr auto Kind = NodeKind::PrimType;
+        Symbol name_;
+        PrimType (IsConst, Symbol);
         auto to_string () const -> std::string override;
     };
 
     struct CustomType : public CommonType<CustomType>
     {
-        std::string name_;
-        CustomType (IsConst, std::string);
+        static constexpr auto Kind = NodeKind::CustomType;
+        Symbol name_;
+        CustomType (IsConst, Symbol);
         auto to_string () const -> std::string override;
     };
 
     struct TemplatedType : public CommonType<TemplatedType>
     {
-        using arg_var_t = std::variant<uptr<Type>, uptr<Expression>>;
-        uptr<Type>             base_;
+        static constexpr auto Kind = NodeKind::TemplatedType;
+        using arg_var_t = std::variant<Type*, Expression*>;
+        Type*                  base_;
         std::vector<arg_var_t> args_;
-        TemplatedType (IsConst, uptr<Type>, std::vector<arg_var_t>);
+        TemplatedType (IsConst, Type*, std::vector<arg_var_t>);
         auto to_string () const -> std::string override;
     };
 
     struct Indirection : public CommonType<Indirection>
     {
-        uptr<Type> pointee_ {};
-        Indirection (IsConst, uptr<Type>);
+        static constexpr auto Kind = NodeKind::Indirection;
+        Type* pointee_ {};
+        Indirection (IsConst, Type*);
         auto to_string () const -> std::string override;
     };
 
     struct Function : public CommonType<Function>
     {
-        std::vector<uptr<Type>> params_;
-        uptr<Type>              ret_;
-        Function (std::vector<uptr<Type>>, uptr<Type>);
+        static constexpr auto Kind = NodeKind::Function;
+        std::vector<Type*> params_;
+        Type*              ret_;
+        Function (std::vector<Type*>, Type*);
         auto to_string () const -> std::string override;
     };
 
     struct Nested : public CommonType<Nested>
     {
-        uptr<Type>  nest_;
-        std::string name_;
-        Nested(IsConst, uptr<Type>, std::string);
+        static constexpr auto Kind = NodeKind::Nested;
+        Type*  nest_;
+        Symbol name_;
+        Nested(IsConst, Type*, Symbol);
         auto to_string () const -> std::string override;
     };
 
@@ -121,53 +167,65 @@ namespace fri
 
     struct VarDefCommon : public Visitable<VarDefCommon>
     {
-        uptr<Type>       type_;
-        std::string      name_;
-        uptr<Expression> initializer_ {};
-        VarDefCommon(uptr<Type>, std::string);
-        VarDefCommon(uptr<Type>, std::string, uptr<Expression>);
+        Type*       type_;
+        Symbol      name_;
+        Expression* initializer_ {};
+        VarDefCommon(Type*, Symbol);
+        VarDefCommon(Type*, Symbol, Expression*);
     };
 
     struct ParamDefinition : public Visitable<ParamDefinition>
     {
         VarDefCommon var_;
-        ParamDefinition(uptr<Type>, std::string);
-        ParamDefinition(uptr<Type>, std::string, uptr<Expression>);
+        ParamDefinition(Type*, Symbol);
+        ParamDefinition(Type*, Symbol, Expression*);
     };
 
     struct FieldDefinition : public Visitable<FieldDefinition>
     {
         VarDefCommon var_;
-        FieldDefinition(uptr<Type>, std::string);
-        FieldDefinition(uptr<Type>, std::string, uptr<Expression>);
+        FieldDefinition(Type*, Symbol);
+        FieldDefinition(Type*, Symbol, Expression*);
     };
 
+    /**
+     *  @brief Arguments of calls and initializers and parameters of functions.
+     *  There are rarely more than three of them, so they are kept inline.
+     */
+    using args_t   = SmallVector<Expression*, 3>;
+    using params_t = SmallVector<ParamDefinition, 3>;
+
 // Expressions:
 
     struct IntLiteral : public VisitableFamily<Expression, IntLiteral>
     {
+        static constexpr auto Kind = NodeKind::IntLiteral;
         std::int64_t num_;
         IntLiteral (std::int64_t);
     };
 
     struct FloatLiteral : public VisitableFamily<Expression, FloatLiteral>
     {
+        static constexpr auto Kind = NodeKind::FloatLiteral;
         double num_;
         FloatLiteral (double);
     };
 
     struct StringLiteral : public VisitableFamily<Expression, StringLiteral>
     {
-        std::string str_;
-        StringLiteral (std::string);
+        static constexpr auto Kind = NodeKind::StringLiteral;
+        Symbol str_;
+        StringLiteral (Symbol);
     };
 
     struct NullLiteral : public VisitableFamily<Expression, NullLiteral>
     {
+        static constexpr auto Kind = NodeKind::NullLiteral;
     };
 
     struct BoolLiteral : public VisitableFamily<Expression, BoolLiteral>
     {
+        static constexpr auto Kind = NodeKind::BoolLiteral;
         bool val_;
         BoolLiteral (bool);
     };
@@ -189,226 +247,287 @@ namespace fri
 
     struct BinaryOperator : public VisitableFamily<Expression, BinaryOperator>
     {
-        BinOpcode        op_;
-        uptr<Expression> lhs_;
-        uptr<Expression> rhs_;
-        BinaryOperator (uptr<Expression>, BinOpcode, uptr<Expression>);
+        static constexpr auto Kind = NodeKind::BinaryOperator;
+        BinOpcode   op_;
+        Expression* lhs_;
+        Expression* rhs_;
+        BinaryOperator (Expression*, BinOpcode, Expression*);
+    };
+
+    /**
+     *  @brief Chain of the same associative operator, e.g. `a + b + c`,
+     *  that would otherwise be a left-deep tree of binary operators.
+     *  Has at least three operands.
+     */
+    struct OperatorChain : public VisitableFamily<Expression, OperatorChain>
+    {
+        static constexpr auto Kind = NodeKind::OperatorChain;
+        BinOpcode op_;
+        args_t    operands_;
+        OperatorChain (BinOpcode, args_t);
     };
 
+    /**
+     *  @brief Checks if operands of @p op can be grouped in any order,
+     *  so that its chains can be kept in @c OperatorChain .
+     */
+    auto is_associative (BinOpcode op) -> bool;
+
     struct UnaryOperator : public VisitableFamily<Expression, UnaryOperator>
     {
-        using arg_variant = std::variant<uptr<Expression>, uptr<Type>>;
+        static constexpr auto Kind = NodeKind::UnaryOperator;
+        using arg_variant = std::variant<Expression*, Type*>;
         UnOpcode    op_;
         arg_variant arg_;
-        UnaryOperator (UnOpcode, uptr<Expression>);
-        UnaryOperator (UnOpcode, uptr<Type>);
+        UnaryOperator (UnOpcode, Expression*);
+        UnaryOperator (UnOpcode, Type*);
     };
 
     struct Parenthesis : public VisitableFamily<Expression, Parenthesis>
     {
-        uptr<Expression> expression_;
-        Parenthesis (uptr<Expression>);
+        static constexpr auto Kind = NodeKind::Parenthesis;
+        Expression* expression_;
+        Parenthesis (Expression*);
     };
 
     struct VarRef : public VisitableFamily<Expression, VarRef>
     {
-        std::string name_;
-        VarRef (std::string);
+        static constexpr auto Kind = NodeKind::VarRef;
+        Symbol name_;
+        VarRef (Symbol);
     };
 
     struct MemberVarRef : public VisitableFamily<Expression, MemberVarRef>
     {
-        bool             indirectBase_;
-        uptr<Expression> base_;
-        std::string      name_;
-        MemberVarRef (uptr<Expression>, std::string);
+        static constexpr auto Kind = NodeKind::MemberVarRef;
+        bool        indirectBase_;
+        Expression* base_;
+        Symbol      name_;
+        MemberVarRef (Expression*, Symbol);
     };
 
     struct New : public VisitableFamily<Expression, New>
     {
-        uptr<Type>                    type_;
-        std::vector<uptr<Expression>> args_;
-        New (uptr<Type>, std::vector<uptr<Expression>>);
+        static constexpr auto Kind = NodeKind::New;
+        Type*  type_;
+        args_t args_;
+        New (Type*, args_t);
     };
 
     struct FunctionCall : public VisitableFamily<Expression, FunctionCall>
     {
-        std::string                   name_;
-        std::vector<uptr<Expression>> args_;
-        FunctionCall (std::string, std::vector<uptr<Expression>>);
+        static constexpr auto Kind = NodeKind::FunctionCall;
+        Symbol name_;
+        args_t args_;
+        FunctionCall (Symbol, args_t);
     };
 
     struct ConstructorCall : public VisitableFamily<Expression, ConstructorCall>
     {
-        uptr<Type>                    type_;
-        std::vector<uptr<Expression>> args_;
-        ConstructorCall (uptr<Type>, std::vector<uptr<Expression>>);
+        static constexpr auto Kind = NodeKind::ConstructorCall;
+        Type*  type_;
+        args_t args_;
+        ConstructorCall (Type*, args_t);
     };
 
     struct DestructorCall : public VisitableFamily<Expression, DestructorCall>
     {
-        uptr<Expression> ex_;
-        DestructorCall (uptr<Expression>);
+        static constexpr auto Kind = NodeKind::DestructorCall;
+        Expression* ex_;
+        DestructorCall (Expression*);
     };
 
     struct MemberFunctionCall : public VisitableFamily<Expression, MemberFunctionCall>
     {
-        bool                          indirectBase_;
-        uptr<Expression>              base_;
-        std::string                   call_;
-        std::vector<uptr<Expression>> args_;
-        MemberFunctionCall (uptr<Expression>, std::string, std::vector<uptr<Expression>>);
+        static constexpr auto Kind = NodeKind::MemberFunctionCall;
+        bool        indirectBase_;
+        Expression* base_;
+        Symbol      call_;
+        args_t      args_;
+        MemberFunctionCall (Expression*, Symbol, args_t);
     };
 
     struct ExpressionCall : public VisitableFamily<Expression, ExpressionCall>
     {
-        uptr<Expression>              ex_;
-        std::vector<uptr<Expression>> args_;
-        ExpressionCall (uptr<Expression>, std::vector<uptr<Expression>>);
+        static constexpr auto Kind = NodeKind::ExpressionCall;
+        Expression* ex_;
+        args_t      args_;
+        ExpressionCall (Expression*, args_t);
     };
 
     struct This : public VisitableFamily<Expression, This>
     {
+        static constexpr auto Kind = NodeKind::This;
     };
 
     struct IfExpression : public VisitableFamily<Expression, IfExpression>
     {
-        uptr<Expression> cond_;
-        uptr<Expression> then_;
-        uptr<Expression> else_;
-        IfExpression (uptr<Expression>, uptr<Expression>, uptr<Expression>);
+        static constexpr auto Kind = NodeKind::IfExpression;
+        Expression* cond_;
+        Expression* then_;
+        Expression* else_;
+        IfExpression (Expression*, Expression*, Expression*);
     };
 
 // Statements:
 
     struct Delete : public VisitableFamily<Statement, Delete>
     {
-        uptr<Expression> ex_;
-        Delete (uptr<Expression>);
+        static constexpr auto Kind = NodeKind::Delete;
+        Expression* ex_;
+        Delete (Expression*);
     };
 
     struct VarDefinition : public VisitableFamily<Statement, VarDefinition>
     {
+        static constexpr auto Kind = NodeKind::VarDefinition;
         VarDefCommon var_;
-        VarDefinition(uptr<Type>, std::string);
-        VarDefinition(uptr<Type>, std::string, uptr<Expression>);
+        VarDefinition(Type*, Symbol);
+        VarDefinition(Type*, Symbol, Expression*);
     };
 
     struct CompoundStatement : public VisitableFamily<Statement, CompoundStatement>
     {
-        std::vector<uptr<Statement>> statements_;
-        CompoundStatement (uptr<Statement>);
-        CompoundStatement (std::vector<uptr<Statement>>);
+        static constexpr auto Kind = NodeKind::CompoundStatement;
+        std::vector<Statement*> statements_;
+        CompoundStatement (Statement*);
+        CompoundStatement (std::vector<Statement*>);
     };
 
     struct Return : public VisitableFamily<Statement, Return>
     {
-        uptr<Expression> expression_;
-        Return (uptr<Expression>);
+        static constexpr auto Kind = NodeKind::Return;
+        Expression* expression_;
+        Return (Expression*);
     };
 
     struct If : public VisitableFamily<Statement, If>
     {
-        uptr<Expression> condition_;
-        CompoundStatement then_;
+        static constexpr auto Kind = NodeKind::If;
+        Expression*                      condition_;
+        CompoundStatement                then_;
         std::optional<CompoundStatement> else_ {};
-        If (uptr<Expression>, CompoundStatement);
-        If (uptr<Expression>, CompoundStatement, CompoundStatement);
+        If (Expression*, CompoundStatement);
+        If (Expression*, CompoundStatement, CompoundStatement);
     };
 
     struct ExpressionStatement : public VisitableFamily<Statement, ExpressionStatement>
     {
-        uptr<Expression> expression_;
-        ExpressionStatement (uptr<Expression>);
+        static constexpr auto Kind = NodeKind::ExpressionStatement;
+        Expression* expression_;
+        ExpressionStatement (Expression*);
+    };
+
+    /**
+     *  @brief Shape of a for loop found once when the loop is created,
+     *  so that backends do not have to inspect its parts on each render.
+     *  Parts that the loop does not have in the expected form are null.
+     */
+    struct LoopShape
+    {
+        VarDefCommon const* counter_ {}; // Variable defined by the loop.
+        Expression const*   from_    {}; // Initializer of the counter.
+        Expression const*   to_      {}; // Bound of the counter in the condition.
+        std::int8_t         step_    {}; // 1 or -1 if the counter is incremented or decremented, 0 otherwise.
+        bool                toIncl_  {}; // Condition admits @c to_ , e.g. <= .
     };
 
     struct ForLoop : public VisitableFamily<Statement, ForLoop>
     {
-        uptr<Statement>  var_;
-        uptr<Expression> cond_;
-        uptr<Expression> inc_;
-        CompoundStatement           body_;
-        ForLoop (uptr<Statement>, uptr<Expression>, uptr<Expression>, CompoundStatement);
+        static constexpr auto Kind = NodeKind::ForLoop;
+        Statement*        var_;
+        Expression*       cond_;
+        Expression*       inc_;
+        CompoundStatement body_;
+        LoopShape         shape_;
+        ForLoop (Statement*, Expression*, Expression*, CompoundStatement);
     };
 
     struct CondLoop
     {
-        uptr<Expression> condition_;
+        Expression*       condition_;
         CompoundStatement body_;
     };
 
     struct WhileLoop : public VisitableFamily<Statement, WhileLoop>
     {
+        static constexpr auto Kind = NodeKind::WhileLoop;
         CondLoop loop_;
-        WhileLoop (uptr<Expression>, CompoundStatement);
+        WhileLoop (Expression*, CompoundStatement);
     };
 
     struct DoWhileLoop : public VisitableFamily<Statement, DoWhileLoop>
     {
+        static constexpr auto Kind = NodeKind::DoWhileLoop;
         CondLoop loop_;
-        DoWhileLoop (uptr<Expression>, CompoundStatement);
+        DoWhileLoop (Expression*, CompoundStatement);
     };
 
     struct Break : public VisitableFamily<Statement, Break>
     {
+        static constexpr auto Kind = NodeKind::Break;
     };
 
     struct Case : public VisitableFamily<Statement, Case>
     {
-        uptr<Expression>  expr_;
+        static constexpr auto Kind = NodeKind::Case;
+        Expression*       expr_;
         CompoundStatement body_;
-        Case (uptr<Expression>, CompoundStatement);
+        Case (Expression*, CompoundStatement);
     };
 
     struct Switch : public VisitableFamily<Statement, Switch>
     {
-        uptr<Expression>                 cond_;
+        static constexpr auto Kind = NodeKind::Switch;
+        Expression*                      cond_;
         std::vector<Case>                cases_;
         std::optional<CompoundStatement> default_;
-        Switch ( uptr<Expression>
+        Switch ( Expression*
                , std::vector<Case> );
-        Switch ( uptr<Expression>
+        Switch ( Expression*
                , std::vector<Case>
                , CompoundStatement );
     };
 
     struct Throw : public VisitableFamily<Statement, Throw>
     {
+        static constexpr auto Kind = NodeKind::Throw;
     };
 
 // Lambda:
 
     struct Lambda : public VisitableFamily<Expression, Lambda>
     {
-        std::vector<ParamDefinition> params_;
-        CompoundStatement            body_;
-        Lambda (std::vector<ParamDefinition>, CompoundStatement);
+        static constexpr auto Kind = NodeKind::Lambda;
+        params_t          params_;
+        CompoundStatement body_;
+        Lambda (params_t, CompoundStatement);
     };
 
 // Other:
 
     struct BaseInitPair
     {
-        uptr<Type>                    base_;
-        std::vector<uptr<Expression>> init_;
-        BaseInitPair( uptr<Type>
-                    , std::vector<uptr<Expression>> );
+        Type*  base_;
+        args_t init_;
+        BaseInitPair( Type*
+                    , args_t );
     };
 
     struct MemberInitPair
     {
-        std::string                   name_;
-        std::vector<uptr<Expression>> init_;
-        MemberInitPair(std::string, std::vector<uptr<Expression>>);
+        Symbol name_;
+        args_t init_;
+        MemberInitPair(Symbol, args_t);
     };
 
     struct Constructor : public Visitable<Constructor>
     {
-        std::vector<ParamDefinition>     params_;
+        params_t                         params_;
         std::vector<BaseInitPair>        baseInitList_;
         std::vector<MemberInitPair>      initList_;
         std::optional<CompoundStatement> body_ {};
-        Constructor( std::vector<ParamDefinition>
+        Constructor( params_t
                    , std::vector<BaseInitPair>
                    , std::vector<MemberInitPair>
                    , std::optional<CompoundStatement> );
@@ -422,21 +541,21 @@ namespace fri
 
     struct Method : public Visitable<Method>
     {
-        std::string                      name_;
-        uptr<Type>            retType_;
-        std::vector<ParamDefinition>     params_;
+        Symbol                           name_;
+        Type*                            retType_;
+        params_t                         params_;
         std::optional<CompoundStatement> body_ {};
-        Method( std::string
-              , uptr<Type>
-              , std::vector<ParamDefinition>
+        Method( Symbol
+              , Type*
+              , params_t
               , std::optional<CompoundStatement> );
     };
 
     struct AliasDecl
     {
-        uptr<Type>  type_;
-        std::string alias_;
-        AliasDecl (uptr<Type>, std::string);
+        Type*  type_;
+        Symbol alias_;
+        AliasDecl (Type*, Symbol);
     };
 
     struct Class : public Visitable<Class>
@@ -449,27 +568,38 @@ namespace fri
         std::optional<Destructor>    destructor_;
         std::vector<Method>          methods_;
         std::vector<FieldDefinition> fields_;
-        std::vector<uptr<Type>>      bases_;
+        std::vector<Type*>           bases_;
         std::vector<AliasDecl>       typedefs_;
+        bool                         isInterface_ {false};
 
         Class (std::string qualName);
         auto name () const -> std::string;
     };
 
-    auto is_interface (Class const&) -> bool;
-    auto is_interface (Type const&) -> bool;
+    /**
+     *  @brief Checks if @p c is an interface, as classified during extraction.
+     */
+    auto is_interface (Class const& c) -> bool;
+
+    /**
+     *  @brief Checks if @p t is an interface, as classified during extraction.
+     */
+    auto is_interface (Type const& t) -> bool;
 
     /**
      *  @brief Code from a translation unit. Just classes for now.
+     *  Owns the arena that holds all nodes of the classes.
      */
     class TranslationUnit
     {
     public:
-        TranslationUnit (std::vector<uptr<Class>> classes);
-        auto get_classes () const -> std::vector<uptr<Class>> const&;
+        TranslationUnit (std::unique_ptr<Arena> arena, std::vector<Class*> classes);
+        auto get_classes () const -> std::vector<Class*> const&;
+        auto get_arena   () const -> Arena const&;
 
     private:
-        std::vector<uptr<Class>> classes_;
+        std::unique_ptr<Arena> arena_;
+        std::vector<Class*>    classes_;
     };
 
     /**
@@ -486,6 +616,7 @@ namespace fri
         virtual auto visit (NullLiteral const&)         -> void = 0;
         virtual auto visit (BoolLiteral const&)         -> void = 0;
         virtual auto visit (BinaryOperator const&)      -> void = 0;
+        virtual auto visit (OperatorChain const&)       -> void = 0;
         virtual auto visit (Parenthesis const&)         -> void = 0;
         virtual auto visit (VarRef const&)              -> void = 0;
         virtual auto visit (MemberVarRef const&)        -> void = 0;
@@ -538,6 +669,7 @@ namespace fri
         auto visit (NullLiteral const&)         -> void override {};
         auto visit (BoolLiteral const&)         -> void override {};
         auto visit (BinaryOperator const&)      -> void override {};
+        auto visit (OperatorChain const&)       -> void override {};
         auto visit (Parenthesis const&)         -> void override {};
         auto visit (VarRef const&)              -> void override {};
         auto visit (MemberVarRef const&)        -> void override {};
@@ -580,35 +712,48 @@ namespace fri
     };
 
     /**
-     *  @brief Checks if visitable type is T.
-     */
-    template<class T>
-    class IsaVisitor : public CodeVisitorAdapter
-    {
-    public:
-        auto visit  (T const&) -> void override;
-        auto result () const   -> bool;
-
-    private:
-        bool result_ {false};
-    };
-
-    /**
-     *  @brief Checks if U is T.
+     *  @brief Checks if node @p u is a @c T .
+     *  @p u is an expression, statement or type or a pointer to one.
+     *  Null pointer is not a @c T .
      */
     template<class T, class U>
     auto isa (U const& u) -> bool
     {
-        auto v = IsaVisitor<T>();
         if constexpr (std::is_pointer_v<U> or is_smart_pointer_v<U>)
         {
-            u->accept(v);
+            return u and u->kind_ == T::Kind;
         }
         else
         {
-            u.accept(v);
+            return u.kind_ == T::Kind;
         }
-        return v.result();
+    }
+
+    /**
+     *  @brief Casts @p u to @c T if it is a @c T .
+     *  @return nullptr if @p u is null or is not a @c T .
+     */
+    template<class T, class U>
+    auto dyn_cast (U const* u) -> T const*
+    {
+        return isa<T>(u) ? static_cast<T const*>(u) : nullptr;
+    }
+
+    /**
+     *  @brief Casts @p u to @c T if it is a @c T .
+     *  @return nullptr if @p u is null or is not a @c T .
+     */
+    template<class T, class U>
+    auto dyn_cast (U* u) -> T*
+    {
+        return isa<T>(u) ? static_cast<T*>(u) : nullptr;
+    }
+
+    template<class VirtualBase, class Derived>
+    VisitableFamily<VirtualBase, Derived>::VisitableFamily
+        () :
+        VirtualBase (Derived::Kind)
+    {
     }
 
     template<class VirtualBase, class Derived>
@@ -624,20 +769,6 @@ namespace fri
     {
         visitor.visit(static_cast<Derived const&>(*this));
     }
-
-    template<class T>
-    auto IsaVisitor<T>::visit
-        (T const&) -> void
-    {
-        result_ = true;
-    }
-
-    template<class T>
-    auto IsaVisitor<T>::result
-        () const -> bool
-    {
-        return result_;
-    }
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include "arena.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+namespace fri
+{
+// Symbol definitions:
+
+    Symbol::Symbol
+        (std::string_view const view) :
+        view_ (view)
+    {
+    }
+
+    Symbol::operator std::string_view
+        () const
+    {
+        return view_;
+    }
+
+    auto Symbol::view
+        () const -> std::string_view
+    {
+        return view_;
+    }
+
+    auto Symbol::str
+        () const -> std::string
+    {
+        return std::string(view_);
+    }
+
+    auto Symbol::empty
+        () const -> bool
+    {
+        return view_.empty();
+    }
+
+    auto operator==
+        (Symbol const l, Symbol const r) -> bool
+    {
+        auto const lv = l.view();
+        auto const rv = r.view();
+        return lv.data() == rv.data() and lv.size() == rv.size();
+    }
+
+// Arena definitions:
+
+    Arena::Arena
+        (Arena& symbols) :
+        symbolOwner_ (symbols.symbolOwner_)
+    {
+    }
+
+    Arena::~Arena
+        ()
+    {
+        for (auto it = finalizers_.rbegin(); it != finalizers_.rend(); ++it)
+        {
+            it->destroy_(it->node_);
+        }
+    }
+
+    auto Arena::intern
+        (std::string_view const s) -> Symbol
+    {
+        if (s.empty())
+        {
+            return Symbol();
+        }
+
+        if (symbolOwner_ == this)
+        {
+            return this->intern(symbols_, s);
+        }
+
+        auto const lock = std::scoped_lock(symbolOwner_->symbolMutex_);
+        return this->intern(symbolOwner_->symbols_, s);
+    }
+
+    auto Arena::adopt
+        (Arena& other) -> void
+    {
+        chunks_.insert( std::end(chunks_)
+                      , std::make_move_iterator(std::begin(other.chunks_))
+                      , std::make_move_iterator(std::end(other.chunks_)) );
+        finalizers_.insert(std::end(finalizers_), std::begin(other.finalizers_), std::end(other.finalizers_));
+        symbols_.insert(std::begin(other.symbols_), std::end(other.symbols_));
+        count_    += other.count_;
+        reserved_ += other.reserved_;
+
+        other.chunks_.clear();
+        other.finalizers_.clear();
+        other.symbols_.clear();
+        other.cursor_   = nullptr;
+        other.end_      = nullptr;
+        other.count_    = 0;
+        other.reserved_ = 0;
+    }
+
+    auto Arena::node_count
+        () const -> std::size_t
+    {
+        return count_;
+    }
+
+    auto Arena::reserved
+        () const -> std::size_t
+    {
+        return reserved_;
+    }
+
+    auto Arena::intern
+        (symbols_t& symbols, std::string_view const s) -> Symbol
+    {
+        auto const it = symbols.find(s);
+        if (it != std::end(symbols))
+        {
+            return Symbol(*it);
+        }
+
+        auto const chars = static_cast<char*>(this->allocate(s.size(), alignof(char)));
+        std::memcpy(chars, s.data(), s.size());
+        return Symbol(*symbols.emplace(chars, s.size()).first);
+    }
+
+    auto Arena::allocate
+        (std::size_t const size, std::size_t const alignment) -> void*
+    {
+        auto constexpr MinChunkSize = std::size_t {4 * 1024};
+        auto constexpr MaxChunkSize = std::size_t {64 * 1024};
+
+        auto space = static_cast<std::size_t>(end_ - cursor_);
+        auto place = static_cast<void*>(cursor_);
+        if (not cursor_ or not std::align(alignment, size, place, space))
+        {
+            // Chunks are not initialized, nodes are constructed in them.
+            // Small units are common, so chunks grow with the arena.
+            auto const chunkSize = std::max(std::clamp(reserved_, MinChunkSize, MaxChunkSize), size + alignment);
+            chunks_.emplace_back(new std::byte[chunkSize]);
+            cursor_    = chunks_.back().get();
+            end_       = cursor_ + chunkSize;
+            reserved_ += chunkSize;
+            space      = chunkSize;
+            place      = cursor_;
+            std::align(alignment, size, place, space);
+        }
+        cursor_ = static_cast<std::byte*>(place) + size;
+        return place;
+    }
+}
@@ -0,0 +1,136 @@
+#ifndef FRI_ARENA_HPP
+#define FRI_ARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace fri
+{
+    /**
+     *  @brief Name or literal interned by an @c Arena . Characters are owned
+     *  by the arena, equal symbols of the same arena share them.
+     */
+    class Symbol
+    {
+    public:
+        Symbol () = default;
+
+        operator std::string_view () const;
+        auto view  () const -> std::string_view;
+        auto str   () const -> std::string;
+        auto empty () const -> bool;
+
+    private:
+        friend class Arena;
+        explicit Symbol (std::string_view);
+
+    private:
+        std::string_view view_ {};
+    };
+
+    /**
+     *  @brief Compares addresses only. Both symbols must be interned
+     *  by the same arena or by arenas that share its symbols.
+     */
+    auto operator== (Symbol, Symbol) -> bool;
+
+    /**
+     *  @brief Monotonic storage for nodes of the abstract code model.
+     *  Nodes are placed into large chunks and are released together
+     *  with the arena. Destructors are run only for nodes that own
+     *  memory of their own, e.g. strings or vectors.
+     */
+    class Arena
+    {
+    public:
+        Arena () = default;
+
+        /**
+         *  @brief Creates arena that interns its symbols among symbols of
+         *  @p symbols , so that equal symbols of both arenas are the same.
+         *  Many arenas, e.g. on different threads, can share @p symbols
+         *  as long as it is not used directly meanwhile. Characters are
+         *  stored in the new arena, which must be adopted by @p symbols .
+         */
+        explicit Arena (Arena& symbols);
+
+        ~Arena ();
+
+        Arena (Arena const&) = delete;
+        auto operator= (Arena const&) -> Arena& = delete;
+
+        /**
+         *  @brief Creates a node that lives as long as the arena.
+         */
+        template<class T, class... Args>
+        auto make (Args&&... args) -> T*;
+
+        /**
+         *  @brief Returns symbol with characters of @p s , which are
+         *  stored only once per arena.
+         */
+        auto intern (std::string_view s) -> Symbol;
+
+        /**
+         *  @brief Takes over all nodes and symbols of @p other , which
+         *  is left empty.
+         */
+        auto adopt (Arena& other) -> void;
+
+        /**
+         *  @brief Number of created nodes.
+         */
+        auto node_count () const -> std::size_t;
+
+        /**
+         *  @brief Number of bytes taken by chunks.
+         */
+        auto reserved () const -> std::size_t;
+
+    private:
+        struct Finalizer
+        {
+            void (*destroy_) (void*);
+            void* node_;
+        };
+
+        using symbols_t = std::unordered_set<std::string_view>;
+
+        auto allocate (std::size_t size, std::size_t alignment) -> void*;
+        auto intern   (symbols_t& symbols, std::string_view s) -> Symbol;
+
+    private:
+        std::vector<std::unique_ptr<std::byte[]>> chunks_;
+        std::vector<Finalizer>                    finalizers_;
+        symbols_t                                 symbols_;
+        Arena*                                    symbolOwner_ {this};
+        std::mutex                                symbolMutex_;
+        std::byte*                                cursor_   {nullptr};
+        std::byte*                                end_      {nullptr};
+        std::size_t                               count_    {0};
+        std::size_t                               reserved_ {0};
+    };
+
+    template<class T, class... Args>
+    auto Arena::make
+        (Args&&... args) -> T*
+    {
+        auto const node = ::new (this->allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        if constexpr (not std::is_trivially_destructible_v<T>)
+        {
+            finalizers_.push_back(Finalizer {[](void* const p) { static_cast<T*>(p)->~T(); }, node});
+        }
+        ++count_;
+        return node;
+    }
+}
+
+#endif
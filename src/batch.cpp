@@ -0,0 +1,156 @@
+#include "batch.hpp"
+
+#include "process_pool.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <unordered_set>
+
+namespace fri
+{
+    namespace
+    {
+        namespace fs = std::filesystem;
+
+        /**
+         *  @brief Maps inputs to output files. Returns nullopt if two
+         *  inputs would be written into the same file.
+         */
+        auto output_paths
+            (CommandLine const& cmd) -> std::optional<std::vector<fs::path>>
+        {
+            auto paths = std::vector<fs::path>();
+            auto names = std::unordered_set<std::string>();
+            for (auto const& input : cmd.inputs_)
+            {
+                auto name = fs::path(input).filename().replace_extension(".rtf");
+                if (not names.insert(name.string()).second)
+                {
+                    std::cerr << "Multiple inputs map to output file: " << name.string() << '\n';
+                    return std::nullopt;
+                }
+                paths.emplace_back(fs::path(*cmd.output_) / name);
+            }
+            return paths;
+        }
+
+        auto write_unit
+            (fs::path const& path, TranslationUnit const& unit, OutputSettings const& settings) -> bool
+        {
+            auto ofst = std::ofstream(path);
+            if (not ofst.is_open())
+            {
+                std::cerr << "Failed to open output file: " << path.string() << '\n';
+                return false;
+            }
+            auto printer = RtfCodePrinter(ofst, settings);
+            generate_pseudocode(unit, printer, settings);
+            return true;
+        }
+
+        auto report_failed
+            (CommandLine const& cmd, std::vector<TaskFailure> const& failed) -> int
+        {
+            if (failed.empty())
+            {
+                return 0;
+            }
+
+            std::cerr << "Failed to process " << failed.size() << " input(s):" << '\n';
+            for (auto const& f : failed)
+            {
+                std::cerr << "  " << cmd.inputs_[f.task_] << " (" << to_string(f.status_) << ")" << '\n';
+            }
+            return 1;
+        }
+
+        /**
+         *  @brief Extracts and renders inputs in this process, possibly on multiple threads.
+         */
+        auto run_in_threads
+            ( CommandLine const&           cmd
+            , ExtractOptions const&        options
+            , CompileCommands const&       commands
+            , std::vector<fs::path> const& outputs
+            , OutputSettings const&        settings ) -> std::vector<TaskFailure>
+        {
+            // Each unit is rendered on the thread that extracted it,
+            // with its own generator and printers.
+            auto writeMutex = std::mutex();
+            auto failed     = std::vector<TaskFailure>();
+            auto const notExtracted = extract_codes(commands, cmd.inputs_, options, cmd.jobs_,
+                [&](std::size_t const i, TranslationUnit unit)
+                {
+                    if (not write_unit(outputs[i], unit, settings))
+                    {
+                        auto lock = std::scoped_lock(writeMutex);
+                        failed.emplace_back(TaskFailure {i, TaskStatus::Failed});
+                    }
+                });
+
+            for (auto const i : notExtracted)
+            {
+                failed.emplace_back(TaskFailure {i, TaskStatus::Failed});
+            }
+            std::ranges::sort(failed, {}, &TaskFailure::task_);
+            return failed;
+        }
+
+        /**
+         *  @brief Extracts and renders each input in one of the worker processes.
+         */
+        auto run_in_processes
+            ( CommandLine const&           cmd
+            , ExtractOptions const&        options
+            , CompileCommands const&       commands
+            , std::vector<fs::path> const& outputs
+            , OutputSettings const&        settings ) -> std::vector<TaskFailure>
+        {
+            auto const timeout = std::chrono::seconds(cmd.timeout_);
+            return fri::run_in_processes(cmd.inputs_.size(), cmd.processes_, timeout, [&](std::size_t const i)
+            {
+                auto written = false;
+                extract_codes(commands, {cmd.inputs_[i]}, options, 1,
+                    [&](std::size_t, TranslationUnit unit)
+                    {
+                        written = write_unit(outputs[i], unit, settings);
+                    });
+                return written;
+            });
+        }
+    }
+
+    auto run_batch
+        (CommandLine const& cmd, ExtractOptions const& options, OutputSettings const& settings) -> int
+    {
+        auto const outputs = output_paths(cmd);
+        if (not outputs)
+        {
+            return 1;
+        }
+
+        auto ec = std::error_code();
+        fs::create_directories(*cmd.output_, ec);
+        if (ec)
+        {
+            std::cerr << "Failed to create output directory: " << *cmd.output_ << '\n';
+            return 1;
+        }
+
+        // Workers started by the process pool share the loaded database.
+        auto const commands = CompileCommands::load(cmd.buildDir_);
+        if (not commands)
+        {
+            return 1;
+        }
+
+        auto const failed = cmd.processes_ > 0
+            ? run_in_processes(cmd, options, *commands, *outputs, settings)
+            : run_in_threads(cmd, options, *commands, *outputs, settings);
+        return report_failed(cmd, failed);
+    }
+}
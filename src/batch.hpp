@@ -0,0 +1,20 @@
+#ifndef FRI_BATCH_HPP
+#define FRI_BATCH_HPP
+
+#include "clang_source_parser.hpp"
+#include "command_line.hpp"
+#include "code_generator.hpp"
+
+namespace fri
+{
+    /**
+     *  @brief Generates pseudocode for all inputs from @p cmd .
+     *  One RTF file is written to the output directory for each input.
+     *  @return exit code of the program.
+     */
+    auto run_batch ( CommandLine const&    cmd
+                   , ExtractOptions const& options
+                   , OutputSettings const& settings ) -> int;
+}
+
+#endif
@@ -0,0 +1,105 @@
+#include "clang_ast_cache.hpp"
+#include "file_manifest.hpp"
+#include "utils.hpp"
+
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Basic/FileSystemOptions.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "llvm/Support/VirtualFileSystem.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace fri
+{
+    auto source_files
+        (clang::SourceManager const& sources) -> std::vector<std::string>
+    {
+        auto& fileSystem = sources.getFileManager().getVirtualFileSystem();
+        auto files = std::vector<std::string>();
+        for (auto it = sources.fileinfo_begin(); it != sources.fileinfo_end(); ++it)
+        {
+            auto realPath = llvm::SmallString<256>();
+            if (not fileSystem.getRealPath(it->first->getName(), realPath))
+            {
+                files.emplace_back(realPath.str().str());
+            }
+        }
+        std::ranges::sort(files);
+        files.erase(std::unique(std::begin(files), std::end(files)), std::end(files));
+        return files;
+    }
+
+// AstCache definitions:
+
+    AstCache::AstCache
+        (std::string directory) :
+        directory_     (std::move(directory)),
+        pchOperations_ (std::make_shared<clang::PCHContainerOperations>())
+    {
+    }
+
+    auto AstCache::load
+        (std::string const& file, std::uint64_t const key) const -> std::unique_ptr<clang::ASTUnit>
+    {
+        auto const path     = this->entry_path(file);
+        auto const manifest = FileManifest::load(path + ".deps");
+        if (not manifest or not manifest->is_current(key))
+        {
+            return nullptr;
+        }
+
+        // Clang complains about files that were touched but not changed,
+        // such units are simply parsed again.
+        auto diagnostics = clang::CompilerInstance::createDiagnostics(
+            new clang::DiagnosticOptions(), new clang::IgnoringDiagConsumer() );
+        return clang::ASTUnit::LoadFromASTFile
+            ( path
+            , pchOperations_->getRawReader()
+            , clang::ASTUnit::LoadEverything
+            , diagnostics
+            , clang::FileSystemOptions() );
+    }
+
+    auto AstCache::store
+        (std::string const& file, std::uint64_t const key, clang::ASTUnit& unit) const -> bool
+    {
+        if (unit.getDiagnostics().hasErrorOccurred())
+        {
+            return false;
+        }
+
+        // Manifest of the previous AST must not outlive it.
+        auto ec = std::error_code();
+        auto const path = this->entry_path(file);
+        std::filesystem::remove(path + ".deps", ec);
+        std::filesystem::create_directories(directory_, ec);
+        if (ec or unit.Save(path))
+        {
+            std::cerr << "Failed to store AST: " << path << '\n';
+            return false;
+        }
+
+        auto const manifest = FileManifest::capture(key, source_files(unit.getSourceManager()));
+        if (not manifest or not manifest->save(path + ".deps"))
+        {
+            std::cerr << "Failed to record files of AST: " << path << '\n';
+            return false;
+        }
+        return true;
+    }
+
+    auto AstCache::entry_path
+        (std::string const& file) const -> std::string
+    {
+        // Inputs from different directories may have the same name.
+        auto name = std::ostringstream();
+        name << std::filesystem::path(file).filename().string()
+             << '-' << std::hex << std::setw(16) << std::setfill('0') << fnv1a(file)
+             << ".ast";
+        return (std::filesystem::path(directory_) / name.str()).string();
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef FRI_CLANG_AST_CACHE_HPP
+#define FRI_CLANG_AST_CACHE_HPP
+
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/ASTUnit.h"
+#include "clang/Frontend/PCHContainerOperations.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace fri
+{
+    /**
+     *  @brief Real paths of all files that were read by the source manager.
+     *  Files that have no real path (e.g. in-memory inputs) are skipped.
+     */
+    auto source_files (clang::SourceManager const&) -> std::vector<std::string>;
+
+    /**
+     *  @brief Serialized clang ASTs of input files stored in a directory.
+     *  An AST is reused as long as none of the files it was parsed from
+     *  changed and it was parsed with the same options and compile command.
+     */
+    class AstCache
+    {
+    public:
+        explicit AstCache (std::string directory);
+
+        /**
+         *  @brief Loads AST of @p file if it is stored and current.
+         *  @param key identifies options and command @p file is parsed with.
+         *  @return nullptr otherwise.
+         */
+        auto load (std::string const& file, std::uint64_t key) const -> std::unique_ptr<clang::ASTUnit>;
+
+        /**
+         *  @brief Stores @p unit parsed from @p file . Units with errors are not stored.
+         *  @param key identifies options and command @p file was parsed with.
+         */
+        auto store (std::string const& file, std::uint64_t key, clang::ASTUnit& unit) const -> bool;
+
+    private:
+        auto entry_path (std::string const& file) const -> std::string;
+
+    private:
+        std::string                                    directory_;
+        std::shared_ptr<clang::PCHContainerOperations> pchOperations_;
+    };
+}
+
+#endif
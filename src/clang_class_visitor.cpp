@@ -1,34 +1,85 @@
 #include "clang_class_visitor.hpp"
 #include "clang_utils.hpp"
+#include "utils.hpp"
 
     #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <optional>
+#include <utility>
 
 namespace fri
 {
     ClassVisitor::ClassVisitor
         ( clang::ASTContext& context
-        , std::vector<std::unique_ptr<Class>>& classes
-        , std::vector<std::string> const& namespaces ) :
-        classes_      (&classes),
-        namespaces_   (&namespaces),
+        , std::vector<Class*>& classes
+        , Arena& arena
+        , ExtractOptions const& options
+        , DiagnosticSink& diagnostics ) :
+        classes_      (classes, arena),
+        arena_        (&arena),
+        namespaces_   (options.namespaces),
+        scope_        (NamespaceTrie::Root),
+        options_      (&options),
         context_      (&context),
-        statementer_  (context),
-        expressioner_ (statementer_, context)
+        diagnostics_  (&diagnostics),
+        types_        (arena, options.interfaces),
+        statementer_  (context, arena, types_, diagnostics),
+        expressioner_ (statementer_, context, arena, types_, diagnostics)
     {
     }
 
+    auto ClassVisitor::TraverseDecl
+        (clang::Decl* decl) -> bool
+    {
+        // Namespaces are decided by their names, our code may be in system headers too.
+        if ( decl
+         and not namespaces_.is_complete(scope_)
+         and not clang::isa<clang::NamespaceDecl>(decl)
+         and context_->getSourceManager().isInSystemHeader(decl->getLocation()) )
+        {
+            return true;
+        }
+        return base::TraverseDecl(decl);
+    }
+
+    auto ClassVisitor::TraverseNamespaceDecl
+        (clang::NamespaceDecl* namespaceDecl) -> bool
+    {
+        if (namespaces_.is_complete(scope_))
+        {
+            return base::TraverseNamespaceDecl(namespaceDecl);
+        }
+
+        auto const name  = namespaceDecl->getName();
+        auto const scope = namespaces_.child(scope_, std::string_view(name.data(), name.size()));
+        if (not scope)
+        {
+            return true;
+        }
+
+        auto const outerScope = std::exchange(scope_, *scope);
+        auto const result     = base::TraverseNamespaceDecl(namespaceDecl);
+        scope_ = outerScope;
+        return result;
+    }
+
     auto ClassVisitor::VisitCXXRecordDecl
         (clang::CXXRecordDecl* classDecl) -> bool
     {
-        auto const qualName = classDecl->getQualifiedNameAsString();
         // Only classes from our namespaces.
-        if (not this->should_visit(qualName))
+        if (not namespaces_.is_complete(scope_))
         {
             return true;
         }
 
-        auto& c = this->get_class(qualName);
-        c.name_ = classDecl->getNameAsString();
+        // Types have no locations, they are reported at the member that uses them.
+        diagnostics_->set_context(classDecl->getLocation());
+        auto const qualName = classDecl->getQualifiedNameAsString();
+        auto& c = classes_.get(qualName);
+        c.name_        = classDecl->getNameAsString();
+        c.isInterface_ = options_->interfaces.is_interface(c.name_);
 
         // If it is a template, read all parameters.
         if (classDecl->isTemplated())
@@ -50,11 +101,11 @@ namespace fri
             // if (bt->isRecordType())
             // {
             //     auto const baseDecl = bt->getAs<clang::RecordType>()->getAsCXXRecordDecl();
-            //     c.bases_.emplace_back(&this->get_class(baseDecl->getQualifiedNameAsString()));
+            //     c.bases_.emplace_back(&classes_.get(baseDecl->getQualifiedNameAsString()));
             // }
             // else if (auto const tt = clang::dyn_cast<clang::TemplateSpecializationType>(bt.getTypePtr()))
             // {
-            //     c.bases_.emplace_back(&this->get_class(tt->getTemplateName().getAsTemplateDecl()->getQualifiedNameAsString()));
+            //     c.bases_.emplace_back(&classes_.get(tt->getTemplateName().getAsTemplateDecl()->getQualifiedNameAsString()));
             // }
             c.bases_.emplace_back(extract_type(context_->getPrintingPolicy(), bt, expressioner_));
         }
@@ -62,18 +113,19 @@ namespace fri
         // Read all member variables.
         for (auto const field : classDecl->fields())
         {
+            diagnostics_->set_context(field->getLocation());
             auto const init = field->getInClassInitializer();
             auto type = extract_type(context_->getPrintingPolicy(), field->getType(), expressioner_);
             if (init)
             {
                 c.fields_.emplace_back( std::move(type)
-                                      , field->getNameAsString()
+                                      , arena_->intern(field->getNameAsString())
                                       , expressioner_.read_expression(init) );
             }
             else
             {
                 c.fields_.emplace_back( std::move(type)
-                                      , field->getNameAsString() );
+                                      , arena_->intern(field->getNameAsString()) );
             }
         }
 
@@ -81,19 +133,20 @@ namespace fri
         for (auto const& tdeclit : classDecl->decls())
         {
             auto const tdecl = &*tdeclit;
+            diagnostics_->set_context(tdecl->getLocation());
             if (auto const varDecl = clang::dyn_cast<clang::VarDecl>(tdecl))
             {
                 auto type = extract_type(context_->getPrintingPolicy(), varDecl->getType(), expressioner_);
                 if (varDecl->getInit())
                 {
                     c.fields_.emplace_back( std::move(type)
-                                          , varDecl->getNameAsString()
+                                          , arena_->intern(varDecl->getNameAsString())
                                           , expressioner_.read_expression(varDecl->getInit()) );
                 }
                 else
                 {
                     c.fields_.emplace_back( std::move(type)
-                                          , varDecl->getNameAsString() );
+                                          , arena_->intern(varDecl->getNameAsString()) );
                 }
             }
         }
@@ -101,61 +154,66 @@ namespace fri
         // Read typedefs.
         for (auto const decl : classDecl->decls())
         {
+            diagnostics_->set_context(decl->getLocation());
             if (auto const aliasDecl = clang::dyn_cast<clang::TypedefDecl>(decl))
             {
                 c.typedefs_.emplace_back( extract_type(context_->getPrintingPolicy(), aliasDecl->getUnderlyingType(), expressioner_)
-                                        , aliasDecl->getNameAsString() );
+                                        , arena_->intern(aliasDecl->getNameAsString()) );
             }
         }
 
         // Read all methods.
         for (auto const methodPtr : classDecl->methods())
         {
+            diagnostics_->set_context(methodPtr->getLocation());
             if (methodPtr->isImplicit())
             {
                 continue;
             }
 
-            // Optional body of Constructor, Destructor or Method.
-            auto methodBody = [this, methodPtr]()
+            // Optional body of Constructor, Destructor or Method, it is extracted
+            // later by extract_bodies. Getting it here loads it if it is stored
+            // lazily, so that extraction only reads the AST.
+            auto methodBody    = std::optional<CompoundStatement>();
+            auto const bodyPtr = options_->outline or methodPtr->isPure()
+                ? nullptr
+                : methodPtr->getBody();
+            auto const defer_body = [&, bodyPtr, methodPtr](BodyOwner const owner, std::size_t const index)
             {
-                if (methodPtr->isPure())
-                {
-                    return std::optional<CompoundStatement> {};
-                }
-
-                auto const bodyPtr = methodPtr->getBody();
-                if (not bodyPtr)
-                {
-                    return std::optional<CompoundStatement> {};
-                }
-
-                statementer_.TraverseStmt(bodyPtr);
-                auto const compound = statementer_.release_compound();
-                if (compound)
+                if (bodyPtr)
                 {
-                    return std::optional<CompoundStatement>(std::move(*compound));
+                    bodies_.push_back(PendingBody {&c, owner, index, bodyPtr, methodPtr->getLocation()});
                 }
-
-                return std::optional<CompoundStatement> {};
-            }();
+            };
 
             // Destructor.
             if (clang::isa<clang::CXXDestructorDecl>(methodPtr))
             {
                 c.destructor_ = Destructor(std::move(methodBody));
+
+                // Previous destructor of the class was replaced together with its body.
+                auto const [it, isNew] = destructors_.try_emplace(&c, bodies_.size());
+                if (isNew)
+                {
+                    bodies_.push_back(PendingBody {&c, BodyOwner::Destructor, 0, bodyPtr, methodPtr->getLocation()});
+                }
+                else
+                {
+                    bodies_[it->second].body_     = bodyPtr;
+                    bodies_[it->second].location_ = methodPtr->getLocation();
+                }
                 continue;
             }
 
             // Parameters.
             auto params = [this, methodPtr]()
             {
-                auto ps = std::vector<ParamDefinition>();
+                auto ps = params_t();
                 for (auto i = 0u; i < methodPtr->getNumParams(); ++i)
                 {
                     auto const param = methodPtr->getParamDecl(i);
                     // param->getInit(); // TODO
-                    ps.emplace_back(extract_type(context_->getPrintingPolicy(), param->getType(), expressioner_), param->getNameAsString());
+                    ps.emplace_back(extract_type(context_->getPrintingPolicy(), param->getType(), expressioner_), arena_->intern(param->getNameAsString()));
                 }
                 return ps;
             }();
@@ -170,21 +228,25 @@ namespace fri
                 }
                 auto baseInitList = std::vector<BaseInitPair>();
                 auto initList = std::vector<MemberInitPair>();
-                for (auto const& init : con->inits())
+                // Initializers are printed only with the definition.
+                if (not options_->outline)
                 {
-                    auto exprs = expressioner_.read_expressions(init->getInit());
-                    if (init->isMemberInitializer())
-                    {
-                        auto name = init->getMember()->getNameAsString();
-                        initList.emplace_back( std::move(name)
-                                             , std::move(exprs) );
-                    }
-                    else if (init->isBaseInitializer())
+                    for (auto const& init : con->inits())
                     {
-                        auto baseType = init->getBaseClass();
-                        auto name = this->get_base_name(baseType);
-                        baseInitList.emplace_back( std::move(name)
+                        auto exprs = expressioner_.read_expressions(init->getInit());
+                        if (init->isMemberInitializer())
+                        {
+                            auto name = arena_->intern(init->getMember()->getNameAsString());
+                            initList.emplace_back( name
                                                  , std::move(exprs) );
+                        }
+                        else if (init->isBaseInitializer())
+                        {
+                            auto baseType = init->getBaseClass();
+                            auto name = this->get_base_name(baseType);
+                            baseInitList.emplace_back( std::move(name)
+                                                     , std::move(exprs) );
+                        }
                     }
                 }
 
@@ -192,13 +254,15 @@ namespace fri
                                             , std::move(baseInitList)
                                             , std::move(initList)
                                             , std::move(methodBody) );
+                defer_body(BodyOwner::Constructor, c.constructors_.size() - 1);
                 continue;
             }
 
             // Normal method.
             auto retType = extract_type(context_->getPrintingPolicy(), methodPtr->getReturnType(), expressioner_);
-            auto name = methodPtr->getNameAsString();
-            c.methods_.emplace_back(std::move(name), std::move(retType), std::move(params), std::move(methodBody));
+            auto name = arena_->intern(methodPtr->getNameAsString());
+            c.methods_.emplace_back(name, std::move(retType), std::move(params), std::move(methodBody));
+            defer_body(BodyOwner::Method, c.methods_.size() - 1);
         }
 
         return true;
@@ -219,7 +283,7 @@ namespace fri
             }
             return std::string("<unknown type>");
         }();
-        auto const c = this->try_get_class(originalName);
+        auto const c = classes_.find_by_name(originalName);
         if (c)
         {
             c->alias_ = aliasName;
@@ -227,8 +291,115 @@ namespace fri
         return true;
     }
 
+    auto ClassVisitor::extract_bodies
+        () -> void
+    {
+        auto const extract = [this](StatementVisitor& statementer, DiagnosticSink& diagnostics, PendingBody const& pending)
+        {
+            if (not pending.body_)
+            {
+                return;
+            }
+
+            diagnostics.set_context(pending.location_);
+            auto compound = statementer.read_compound(pending.body_);
+            if (compound)
+            {
+                this->body_slot(pending) = std::move(*compound);
+            }
+        };
+
+        // Lazy loading from an external source is not thread safe,
+        // dumps of verbose diagnostics would get mixed.
+        auto const isExternal = context_->getExternalSource() != nullptr;
+        auto const jobs = isExternal or options_->verbose
+            ? std::size_t {1}
+            : std::min<std::size_t>(options_->bodyJobs, bodies_.size());
+        if (isExternal and options_->bodyJobs > 1)
+        {
+            static auto noted = std::atomic<bool>(false);
+            if (not noted.exchange(true))
+            {
+                std::cerr << "Method bodies are extracted on a single thread, "
+                          << "the unit uses a precompiled header, preamble or stored AST." << '\n';
+            }
+        }
+
+        if (jobs <= 1)
+        {
+            for (auto const& pending : bodies_)
+            {
+                extract(statementer_, *diagnostics_, pending);
+            }
+        }
+        else
+        {
+            // Visitors keep the statement being extracted and arenas
+            // are not synchronized, each thread needs its own. Symbols
+            // and types are shared, so that they are the same as if
+            // the bodies were extracted here.
+            auto sinks  = std::vector<DiagnosticSink>();
+            auto arenas = std::deque<Arena>();
+            sinks.reserve(jobs);
+            for (auto w = std::size_t {0}; w < jobs; ++w)
+            {
+                sinks.emplace_back(context_->getSourceManager(), false);
+                arenas.emplace_back(*arena_);
+            }
+
+            // Diagnostics are kept per body and merged in the order of bodies,
+            // so that the same locations are reported regardless of which
+            // thread extracted which body.
+            auto bodySinks = std::vector<std::optional<DiagnosticSink>>(bodies_.size());
+            auto next      = std::atomic<std::size_t>(0);
+            run_parallel(jobs, static_cast<unsigned>(jobs), [&](std::size_t const w)
+            {
+                auto statementer = StatementVisitor(*context_, arenas[w], types_, sinks[w]);
+                for (auto i = next++; i < bodies_.size(); i = next++)
+                {
+                    extract(statementer, sinks[w], bodies_[i]);
+                    if (not sinks[w].empty())
+                    {
+                        bodySinks[i] = std::exchange(sinks[w], DiagnosticSink(context_->getSourceManager(), false));
+                    }
+                }
+            });
+
+            for (auto const& sink : bodySinks)
+            {
+                if (sink)
+                {
+                    diagnostics_->merge(*sink);
+                }
+            }
+            for (auto& arena : arenas)
+            {
+                arena_->adopt(arena);
+            }
+        }
+
+        bodies_.clear();
+        destructors_.clear();
+    }
+
+    auto ClassVisitor::body_slot
+        (PendingBody const& pending) -> std::optional<CompoundStatement>&
+    {
+        switch (pending.owner_)
+        {
+            case BodyOwner::Constructor:
+                return pending.class_->constructors_[pending.index_].body_;
+
+            case BodyOwner::Destructor:
+                return pending.class_->destructor_->body_;
+
+            default:
+                return pending.class_->methods_[pending.index_].body_;
+        }
+    }
+
     auto ClassVisitor::get_base_name
-        (clang::Type const* t) -> std::unique_ptr<Type>
+        (clang::Type const* t) -> Type*
     {
         if (auto icn = clang::dyn_cast<clang::InjectedClassNameType>(t))
         {
@@ -246,49 +417,14 @@ namespace fri
                 auto const arg = tst->getArg(i);
                 args.emplace_back(extract_type(context_->getPrintingPolicy(), arg.getAsType(), expressioner_));
             }
-            return std::make_unique<TemplatedType>( IsConst(false)
-                                                  , std::make_unique<CustomType>(IsConst(false), name)
-                                                  , std::move(args) );
+            return types_.templated_type( IsConst(false)
+                                        , types_.custom_type(IsConst(false), arena_->intern(name))
+                                        , std::move(args) );
         }
         else
         {
                 // t->dump();
-            return std::make_unique<CustomType>(IsConst(false), "base");
+            return types_.custom_type(IsConst(false), arena_->intern("base"));
         }
     }
-
-    auto ClassVisitor::get_class
-        (std::string const& name) -> Class&
-    {
-        auto const it = std::find_if(std::begin(*classes_), std::end(*classes_), [&name](auto const& c)
-        {
-            return c->qualName_ == name;
-        });
-
-        if (std::end(*classes_) != it)
-        {
-            return **it;
-        }
-
-        return *classes_->emplace_back(std::make_unique<Class>(name));
-    }
-
-    auto ClassVisitor::try_get_class
-        (std::string_view const name) -> Class*
-    {
-        auto const it = std::find_if(std::begin(*classes_), std::end(*classes_), [name](auto const& c)
-        {
-            return c->qualName_.ends_with(name);
-        });
-        return it != std::end(*classes_) ? it->get() : nullptr;
-    }
-
-    auto ClassVisitor::should_visit
-        (std::string_view qualName) const -> bool
-    {
-        return std::any_of(std::begin(*namespaces_), std::end(*namespaces_), [qualName](auto const& n)
-        {
-            return qualName.starts_with(n);
-        });
-    }
 }
\ No newline at end of file
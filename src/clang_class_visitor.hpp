@@ -2,8 +2,13 @@
 #define FRI_CLANG_CLASS_VISITOR_HPP
 
 #include "clang/AST/RecursiveASTVisitor.h"
+#include "clang_source_parser.hpp"
 #include "clang_statement_visitor.hpp"
+#include "class_registry.hpp"
+#include "namespace_trie.hpp"
 #include <memory>
+#include <optional>
+#include <unordered_map>
 #include <vector>
 
 namespace fri
@@ -12,24 +17,73 @@ namespace fri
     {
     public:
         explicit ClassVisitor ( clang::ASTContext& context
-                              , std::vector<std::unique_ptr<Class>>& classes
-                              , std::vector<std::string> const& namespaces );
+                              , std::vector<Class*>& classes
+                              , Arena& arena
+                              , ExtractOptions const& options
+                              , DiagnosticSink& diagnostics );
+
+        /**
+         *  @brief Skips declarations from system headers that are not
+         *  in one of our namespaces.
+         */
+        auto TraverseDecl (clang::Decl*) -> bool;
+
+        /**
+         *  @brief Descends only into namespaces that may contain our code.
+         */
+        auto TraverseNamespaceDecl (clang::NamespaceDecl*) -> bool;
 
         auto VisitCXXRecordDecl (clang::CXXRecordDecl*) -> bool;
         auto VisitTypeAliasTemplateDecl (clang::TypeAliasTemplateDecl*) -> bool;
 
+        /**
+         *  @brief Extracts bodies of methods found by the traversal.
+         *  Bodies are extracted on multiple threads if requested by
+         *  @c ExtractOptions::bodyJobs and if the AST is not loaded lazily
+         *  from a precompiled header or preamble. Nodes created by other
+         *  threads are moved into the arena afterwards.
+         */
+        auto extract_bodies () -> void;
+
     private:
-        auto get_base_name (clang::Type const*) -> std::unique_ptr<Type>;
-        auto get_class     (std::string const&) -> Class&;
-        auto try_get_class (std::string_view)   -> Class*;
-        auto should_visit  (std::string_view qalName) const -> bool;
+        enum class BodyOwner
+        {
+            Constructor, Destructor, Method
+        };
+
+        /**
+         *  @brief Body that is extracted after the traversal.
+         */
+        struct PendingBody
+        {
+            Class*                class_;
+            BodyOwner             owner_;
+            std::size_t           index_;
+            clang::Stmt*          body_;
+            clang::SourceLocation location_;
+        };
 
     private:
-        std::vector<std::unique_ptr<Class>>* classes_;
-        std::vector<std::string> const*      namespaces_;
-        clang::ASTContext*                   context_;
-        StatementVisitor                     statementer_;
-        ExpressionVisitor                    expressioner_;
+        auto get_base_name (clang::Type const*) -> Type*;
+        auto body_slot     (PendingBody const&) -> std::optional<CompoundStatement>&;
+
+    private:
+        using base = clang::RecursiveASTVisitor<ClassVisitor>;
+
+    private:
+        ClassRegistry         classes_;
+        Arena*                arena_;
+        NamespaceTrie         namespaces_;
+        NamespaceTrie::node_t scope_;
+        ExtractOptions const* options_;
+        clang::ASTContext*    context_;
+        DiagnosticSink*       diagnostics_;
+        TypePool              types_;
+        StatementVisitor      statementer_;
+        ExpressionVisitor     expressioner_;
+
+        std::vector<PendingBody>                bodies_;
+        std::unordered_map<Class*, std::size_t> destructors_;
     };
 }
 
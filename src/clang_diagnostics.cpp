@@ -0,0 +1,254 @@
+#include "clang_diagnostics.hpp"
+
+#include "clang/Basic/DiagnosticFrontend.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace fri
+{
+    namespace
+    {
+        auto constexpr MaxLocations = std::size_t {64};
+
+        /**
+         *  @brief Reader of a precompiled header reports mismatched options and
+         *  stale files as serialization errors, errors in the source are of
+         *  other kinds.
+         */
+        auto is_pch_diagnostic
+            (unsigned const id) -> bool
+        {
+            auto const first = static_cast<unsigned>(clang::diag::DIAG_START_SERIALIZATION);
+            auto const last  = static_cast<unsigned>(clang::diag::DIAG_START_LEX);
+            return (id >= first and id < last) or id == clang::diag::err_fe_unable_to_load_pch;
+        }
+    }
+
+// DiagnosticSink definitions:
+
+    DiagnosticSink::DiagnosticSink
+        (clang::SourceManager const& sources, bool const verbose) :
+        sources_  (&sources),
+        verbose_  (verbose),
+        context_  (),
+        entries_  (),
+        index_    (),
+        dropped_  (0),
+        recorded_ (0)
+    {
+    }
+
+    auto DiagnosticSink::set_context
+        (clang::SourceLocation const location) -> void
+    {
+        context_ = location;
+    }
+
+    auto DiagnosticSink::unknown_type
+        (clang::Type const* const type) -> void
+    {
+        if (this->record("Unknown type", type->getTypeClassName(), context_) and verbose_)
+        {
+            type->dump();
+        }
+    }
+
+    auto DiagnosticSink::unknown_expression
+        (clang::Stmt const* const expr) -> void
+    {
+        if (this->record("Unknown expression", expr->getStmtClassName(), expr->getBeginLoc()) and verbose_)
+        {
+            expr->dump();
+        }
+    }
+
+    auto DiagnosticSink::unexpected_in_switch
+        (clang::Stmt const* const stmt) -> void
+    {
+        if (this->record("Unexpected statement in switch", stmt->getStmtClassName(), stmt->getBeginLoc()) and verbose_)
+        {
+            stmt->dump();
+        }
+    }
+
+    auto DiagnosticSink::empty
+        () const -> bool
+    {
+        return entries_.empty() and dropped_ == 0;
+    }
+
+    auto DiagnosticSink::recorded
+        () const -> std::size_t
+    {
+        return recorded_;
+    }
+
+    auto DiagnosticSink::print
+        (std::ostream& ost) const -> void
+    {
+        for (auto const& e : entries_)
+        {
+            ost << std::get<2>(e.key_).printToString(*sources_) << ": " << std::get<0>(e.key_) << ": " << std::get<1>(e.key_);
+            if (e.count_ > 1)
+            {
+                ost << " (" << e.count_ << "x)";
+            }
+            ost << '\n';
+        }
+
+        if (dropped_ > 0)
+        {
+            ost << "... and " << dropped_ << " more unknown construct(s)" << '\n';
+        }
+    }
+
+    auto DiagnosticSink::merge
+        (DiagnosticSink const& other) -> void
+    {
+        for (auto const& e : other.entries_)
+        {
+            this->record(e.key_, e.count_);
+        }
+        dropped_  += other.dropped_;
+        recorded_ += other.recorded_;
+    }
+
+    auto DiagnosticSink::record
+        (char const* const kind, char const* const name, clang::SourceLocation const location) -> bool
+    {
+        ++recorded_;
+        auto const isNew = this->record(key_t(kind, name, location), 1);
+        if (isNew and verbose_)
+        {
+            llvm::errs() << "## " << kind << " at " << location.printToString(*sources_) << ":\n";
+        }
+        return isNew;
+    }
+
+    auto DiagnosticSink::record
+        (key_t const& key, std::size_t const count) -> bool
+    {
+        auto const it = index_.find(key);
+        if (it != std::end(index_))
+        {
+            entries_[it->second].count_ += count;
+            return false;
+        }
+
+        if (entries_.size() == MaxLocations)
+        {
+            dropped_ += count;
+            return false;
+        }
+
+        index_.emplace(key, entries_.size());
+        entries_.push_back(Entry {key, count});
+        return true;
+    }
+
+// ErrorDiagConsumer definitions:
+
+    ErrorDiagConsumer::ErrorDiagConsumer
+        ( clang::DiagnosticConsumer* const           next
+        , std::unique_ptr<clang::DiagnosticConsumer> owned ) :
+        next_       (next),
+        owned_      (std::move(owned)),
+        forwarding_ (false)
+    {
+    }
+
+    auto ErrorDiagConsumer::BeginSourceFile
+        (clang::LangOptions const& langOptions, clang::Preprocessor const* preprocessor) -> void
+    {
+        next_->BeginSourceFile(langOptions, preprocessor);
+    }
+
+    auto ErrorDiagConsumer::EndSourceFile
+        () -> void
+    {
+        next_->EndSourceFile();
+    }
+
+    auto ErrorDiagConsumer::finish
+        () -> void
+    {
+        next_->finish();
+    }
+
+    auto ErrorDiagConsumer::HandleDiagnostic
+        (clang::DiagnosticsEngine::Level const level, clang::Diagnostic const& info) -> void
+    {
+        clang::DiagnosticConsumer::HandleDiagnostic(level, info);
+
+        // Notes belong to the preceding diagnostic.
+        if (level != clang::DiagnosticsEngine::Note)
+        {
+            forwarding_ = level >= clang::DiagnosticsEngine::Error;
+        }
+
+        if (forwarding_)
+        {
+            next_->HandleDiagnostic(level, info);
+        }
+    }
+
+    auto report_errors_only
+        (clang::DiagnosticsEngine& engine) -> void
+    {
+        auto const next  = engine.getClient();
+        auto       owned = engine.takeClient();
+        engine.setClient(new ErrorDiagConsumer(next, std::move(owned)), true);
+    }
+
+// PchDiagConsumer definitions:
+
+    PchDiagConsumer::PchDiagConsumer
+        ( clang::DiagnosticConsumer* const           next
+        , std::unique_ptr<clang::DiagnosticConsumer> owned
+        , std::function<void ()>                     rejected ) :
+        next_     (next),
+        owned_    (std::move(owned)),
+        rejected_ (std::move(rejected)),
+        reported_ (false)
+    {
+    }
+
+    auto PchDiagConsumer::BeginSourceFile
+        (clang::LangOptions const& langOptions, clang::Preprocessor const* preprocessor) -> void
+    {
+        next_->BeginSourceFile(langOptions, preprocessor);
+    }
+
+    auto PchDiagConsumer::EndSourceFile
+        () -> void
+    {
+        next_->EndSourceFile();
+    }
+
+    auto PchDiagConsumer::finish
+        () -> void
+    {
+        next_->finish();
+    }
+
+    auto PchDiagConsumer::HandleDiagnostic
+        (clang::DiagnosticsEngine::Level const level, clang::Diagnostic const& info) -> void
+    {
+        clang::DiagnosticConsumer::HandleDiagnostic(level, info);
+
+        if (is_pch_diagnostic(info.getID()) and level >= clang::DiagnosticsEngine::Error and not reported_)
+        {
+            reported_ = true;
+            rejected_();
+        }
+
+        next_->HandleDiagnostic(level, info);
+    }
+
+    auto report_pch_rejection
+        (clang::DiagnosticsEngine& engine, std::function<void ()> rejected) -> void
+    {
+        auto const next  = engine.getClient();
+        auto       owned = engine.takeClient();
+        engine.setClient(new PchDiagConsumer(next, std::move(owned), std::move(rejected)), true);
+    }
+}
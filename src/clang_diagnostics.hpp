@@ -0,0 +1,147 @@
+#ifndef FRI_CLANG_DIAGNOSTICS_HPP
+#define FRI_CLANG_DIAGNOSTICS_HPP
+
+#include "clang/AST/Stmt.h"
+#include "clang/AST/Type.h"
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/SourceManager.h"
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace fri
+{
+    /**
+     *  @brief Collects constructs that the extraction does not model.
+     *  Each construct is recorded once per location along with the number
+     *  of its occurrences. Only a limited number of locations is kept,
+     *  the rest is just counted. Nodes are dumped only if verbose.
+     */
+    class DiagnosticSink
+    {
+    public:
+        DiagnosticSink (clang::SourceManager const& sources, bool verbose);
+
+        /**
+         *  @brief Sets location reported for constructs that have none, e.g. types.
+         */
+        auto set_context (clang::SourceLocation location) -> void;
+
+        auto unknown_type         (clang::Type const* type) -> void;
+        auto unknown_expression   (clang::Stmt const* expr) -> void;
+        auto unexpected_in_switch (clang::Stmt const* stmt) -> void;
+
+        auto empty () const -> bool;
+
+        /**
+         *  @brief Number of recorded occurrences, including repeated ones.
+         */
+        auto recorded () const -> std::size_t;
+
+        /**
+         *  @brief Adds constructs recorded by @p other , e.g. on another thread.
+         */
+        auto merge (DiagnosticSink const& other) -> void;
+
+        /**
+         *  @brief Prints recorded constructs, one per line.
+         */
+        auto print (std::ostream& ost) const -> void;
+
+    private:
+        using key_t = std::tuple<char const*, char const*, clang::SourceLocation>;
+
+        /**
+         *  @brief Location is formatted only when printed. Formatting reads
+         *  caches of the source manager, so sinks on other threads must not.
+         */
+        struct Entry
+        {
+            key_t       key_;
+            std::size_t count_;
+        };
+
+    private:
+        /**
+         *  @return true if it is the first occurrence at @p location .
+         */
+        auto record (char const* kind, char const* name, clang::SourceLocation location) -> bool;
+
+        /**
+         *  @return true if it is the first occurrence of @p key .
+         */
+        auto record (key_t const& key, std::size_t count) -> bool;
+
+    private:
+        clang::SourceManager const*  sources_;
+        bool                         verbose_;
+        clang::SourceLocation        context_;
+        std::vector<Entry>           entries_;
+        std::map<key_t, std::size_t> index_;
+        std::size_t                  dropped_;
+        std::size_t                  recorded_;
+    };
+
+    /**
+     *  @brief Forwards only errors to another consumer, so that warnings
+     *  about code that is never rendered are not even formatted.
+     */
+    class ErrorDiagConsumer : public clang::DiagnosticConsumer
+    {
+    public:
+        ErrorDiagConsumer ( clang::DiagnosticConsumer*                 next
+                          , std::unique_ptr<clang::DiagnosticConsumer> owned );
+
+        auto BeginSourceFile  (clang::LangOptions const&, clang::Preprocessor const*) -> void override;
+        auto EndSourceFile    () -> void override;
+        auto finish           () -> void override;
+        auto HandleDiagnostic (clang::DiagnosticsEngine::Level, clang::Diagnostic const&) -> void override;
+
+    private:
+        clang::DiagnosticConsumer*                 next_;
+        std::unique_ptr<clang::DiagnosticConsumer> owned_;
+        bool                                       forwarding_;
+    };
+
+    /**
+     *  @brief Replaces client of @p engine with @c ErrorDiagConsumer .
+     */
+    auto report_errors_only (clang::DiagnosticsEngine& engine) -> void;
+
+    /**
+     *  @brief Forwards diagnostics to another consumer and calls back once
+     *  clang rejects the precompiled header, e.g. because it was built with
+     *  other options or a header changed since.
+     */
+    class PchDiagConsumer : public clang::DiagnosticConsumer
+    {
+    public:
+        PchDiagConsumer ( clang::DiagnosticConsumer*                 next
+                        , std::unique_ptr<clang::DiagnosticConsumer> owned
+                        , std::function<void ()>                     rejected );
+
+        auto BeginSourceFile  (clang::LangOptions const&, clang::Preprocessor const*) -> void override;
+        auto EndSourceFile    () -> void override;
+        auto finish           () -> void override;
+        auto HandleDiagnostic (clang::DiagnosticsEngine::Level, clang::Diagnostic const&) -> void override;
+
+    private:
+        clang::DiagnosticConsumer*                 next_;
+        std::unique_ptr<clang::DiagnosticConsumer> owned_;
+        std::function<void ()>                     rejected_;
+        bool                                       reported_;
+    };
+
+    /**
+     *  @brief Replaces client of @p engine with @c PchDiagConsumer .
+     */
+    auto report_pch_rejection (clang::DiagnosticsEngine& engine, std::function<void ()> rejected) -> void;
+}
+
+#endif
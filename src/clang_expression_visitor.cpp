@@ -1,87 +1,553 @@
 #include "clang_expression_visitor.hpp"
 #include "clang_statement_visitor.hpp"
 #include "clang_utils.hpp"
-    #include <iostream>
+
+#include <cstdint>
+#include <string>
+#include <utility>
 
 namespace fri
 {
+    namespace
+    {
+        /**
+         *  @brief Ways in which a call is read, given by its callee.
+         */
+        enum class CallForm : std::uint8_t
+        {
+            None, Assign, Destructor, Member, Function, Expression, Unknown
+        };
+
+        /**
+         *  @brief Finds how call @p c is read.
+         *  @return None if no expression is made of it.
+         */
+        auto call_form
+            (clang::CallExpr* const c) -> CallForm
+        {
+            if (auto const o = clang::dyn_cast<clang::CXXOperatorCallExpr>(c))
+            {
+                // TODO is infix
+                return o->getOperator() == clang::OverloadedOperatorKind::OO_Equal ? CallForm::Assign : CallForm::None;
+            }
+
+            if (c->child_begin() == c->child_end())
+            {
+                return CallForm::None;
+            }
+
+            auto const fc = *c->child_begin();
+            if (clang::isa<clang::CXXPseudoDestructorExpr>(fc))
+            {
+                return CallForm::Destructor;
+            }
+            else if ( clang::isa<clang::UnresolvedMemberExpr>(fc)
+                   or clang::isa<clang::MemberExpr>(fc)
+                   or clang::isa<clang::CXXDependentScopeMemberExpr>(fc) )
+            {
+                return CallForm::Member;
+            }
+            else if (clang::isa<clang::UnresolvedLookupExpr>(fc))
+            {
+                return CallForm::Function;
+            }
+            else if (auto const v = clang::dyn_cast<clang::DeclRefExpr>(fc))
+            {
+                return clang::isa<clang::FunctionProtoType>(v->getType()) ? CallForm::Function : CallForm::Expression;
+            }
+            else if (auto const ic = clang::dyn_cast<clang::ImplicitCastExpr>(fc))
+            {
+                auto const subExpr = ic->getSubExpr();
+                if (not subExpr)
+                {
+                    return CallForm::Unknown;
+                }
+                return clang::isa<clang::FunctionProtoType>(subExpr->getType().getTypePtr()) ? CallForm::Function : CallForm::None;
+            }
+            return CallForm::Unknown;
+        }
+
+        /**
+         *  @brief Returns object on which member function is called by @p callee
+         *  or null if it is called on this implicitly.
+         */
+        auto member_base
+            (clang::Stmt* const callee) -> clang::Expr*
+        {
+            if (auto const um = clang::dyn_cast<clang::UnresolvedMemberExpr>(callee))
+            {
+                return um->isImplicitAccess() ? nullptr : um->getBase();
+            }
+            else if (auto const m = clang::dyn_cast<clang::MemberExpr>(callee))
+            {
+                return m->isImplicitAccess() ? nullptr : m->getBase();
+            }
+            else if (auto const dm = clang::dyn_cast<clang::CXXDependentScopeMemberExpr>(callee))
+            {
+                return dm->isImplicitAccess() ? nullptr : dm->getBase();
+            }
+            return nullptr;
+        }
+
+        /**
+         *  @brief Returns name of function called by @p callee .
+         */
+        auto callee_name
+            (clang::Stmt* const callee) -> std::string
+        {
+            if (auto const um = clang::dyn_cast<clang::UnresolvedMemberExpr>(callee))
+            {
+                return um->getMemberNameInfo().getAsString();
+            }
+            else if (auto const m = clang::dyn_cast<clang::MemberExpr>(callee))
+            {
+                return m->getMemberNameInfo().getAsString();
+            }
+            else if (auto const dm = clang::dyn_cast<clang::CXXDependentScopeMemberExpr>(callee))
+            {
+                return dm->getMemberNameInfo().getAsString();
+            }
+            else if (auto const unr = clang::dyn_cast<clang::UnresolvedLookupExpr>(callee))
+            {
+                return unr->getName().getAsString();
+            }
+            else if (auto const v = clang::dyn_cast<clang::DeclRefExpr>(callee))
+            {
+                return v->getNameInfo().getAsString();
+            }
+            else if (auto const ic = clang::dyn_cast<clang::ImplicitCastExpr>(callee); ic and ic->getSubExpr())
+            {
+                auto const dre = clang::dyn_cast<clang::DeclRefExpr>(ic->getSubExpr());
+                return dre ? dre->getNameInfo().getName().getAsString() : "<unknown name>";
+            }
+            return "<unknown call type>";
+        }
+
+        /**
+         *  @brief Checks whether @p s is a list of expressions,
+         *  which stands for its first expression inside of other expression.
+         */
+        auto is_list
+            (clang::Stmt* const s) -> bool
+        {
+            return clang::isa_and_nonnull<clang::ParenListExpr>(s)
+                or clang::isa_and_nonnull<clang::CXXConstructExpr>(s);
+        }
+
+        /**
+         *  @brief Returns operands of a node deferred by the visitor
+         *  in the order in which they are read.
+         */
+        auto operands_of
+            (clang::Stmt* const s) -> llvm::SmallVector<clang::Stmt*, 3>
+        {
+            auto operands     = llvm::SmallVector<clang::Stmt*, 3>();
+            auto const append = [&operands](auto&& range)
+            {
+                for (auto const e : range)
+                {
+                    operands.push_back(e);
+                }
+            };
+
+            if (auto const b = clang::dyn_cast<clang::BinaryOperator>(s))
+            {
+                return {b->getLHS(), b->getRHS()};
+            }
+            else if (auto const uo = clang::dyn_cast<clang::UnaryOperator>(s))
+            {
+                return {uo->getSubExpr()};
+            }
+            else if (auto const p = clang::dyn_cast<clang::ParenExpr>(s))
+            {
+                return {p->getSubExpr()};
+            }
+            else if (auto const c = clang::dyn_cast<clang::ConditionalOperator>(s))
+            {
+                return {c->getCond(), c->getTrueExpr(), c->getFalseExpr()};
+            }
+            else if (auto const m = clang::dyn_cast<clang::MemberExpr>(s))
+            {
+                return m->isImplicitAccess() ? llvm::SmallVector<clang::Stmt*, 3>()
+                                             : llvm::SmallVector<clang::Stmt*, 3> {m->getBase()};
+            }
+            else if (auto const r = clang::dyn_cast<clang::CXXDependentScopeMemberExpr>(s))
+            {
+                return r->isImplicitAccess() ? llvm::SmallVector<clang::Stmt*, 3>()
+                                             : llvm::SmallVector<clang::Stmt*, 3> {r->getBase()};
+            }
+            else if (auto const t = clang::dyn_cast<clang::UnaryExprOrTypeTraitExpr>(s))
+            {
+                return {t->getArgumentExpr()};
+            }
+            else if (auto const pl = clang::dyn_cast<clang::ParenListExpr>(s))
+            {
+                append(pl->exprs());
+            }
+            else if (auto const ce = clang::dyn_cast<clang::CXXConstructExpr>(s))
+            {
+                append(ce->arguments());
+            }
+            else if (auto const uc = clang::dyn_cast<clang::CXXUnresolvedConstructExpr>(s))
+            {
+                append(uc->arguments());
+            }
+            else if (auto const n = clang::dyn_cast<clang::CXXNewExpr>(s))
+            {
+                for (auto const arg : n->children())
+                {
+                    if (auto const list = clang::dyn_cast<clang::ParenListExpr>(arg))
+                    {
+                        append(list->children());
+                    }
+                }
+            }
+            else if (auto const call = clang::dyn_cast<clang::CallExpr>(s))
+            {
+                switch (call_form(call))
+                {
+                    case CallForm::Assign:
+                        for (auto i = 0u; i < call->getNumArgs() and i < 2; ++i)
+                        {
+                            operands.push_back(call->getArg(i));
+                        }
+                        break;
+
+                    case CallForm::Destructor:
+                        operands.push_back(clang::cast<clang::CXXPseudoDestructorExpr>(*call->child_begin())->getBase());
+                        break;
+
+                    case CallForm::Member:
+                        if (auto const base = member_base(*call->child_begin()))
+                        {
+                            operands.push_back(base);
+                        }
+                        append(call->arguments());
+                        break;
+
+                    case CallForm::Expression:
+                        operands.push_back(*call->child_begin());
+                        append(call->arguments());
+                        break;
+
+                    case CallForm::Function:
+                    case CallForm::Unknown:
+                        append(call->arguments());
+                        break;
+
+                    case CallForm::None:
+                        break;
+                }
+            }
+            return operands;
+        }
+
+        /**
+         *  @brief Creates binary operator in @p arena . If @p lhs is a chain
+         *  of the same associative operator, @p rhs is appended to it instead,
+         *  so that long chains are kept in a single node.
+         */
+        auto make_binary
+            (Expression* const lhs, BinOpcode const op, Expression* const rhs, Arena& arena) -> Expression*
+        {
+            if (is_associative(op))
+            {
+                if (auto const chain = dyn_cast<OperatorChain>(lhs); chain and chain->op_ == op)
+                {
+                    chain->operands_.push_back(rhs);
+                    return chain;
+                }
+                if (auto const bin = dyn_cast<BinaryOperator>(lhs); bin and bin->op_ == op)
+                {
+                    return arena.make<OperatorChain>(op, args_t {bin->lhs_, bin->rhs_, rhs});
+                }
+            }
+            return arena.make<BinaryOperator>(lhs, op, rhs);
+        }
+
+        /**
+         *  @brief Takes last @p count expressions of @p operands in their order.
+         */
+        auto take_args
+            (std::vector<Expression*>& operands, std::size_t const count) -> args_t
+        {
+            auto const first = operands.end() - static_cast<std::ptrdiff_t>(count);
+            auto args = args_t();
+            args.reserve(count);
+            for (auto it = first; it != operands.end(); ++it)
+            {
+                args.push_back(*it);
+            }
+            operands.erase(first, operands.end());
+            return args;
+        }
+    }
+
     ExpressionVisitor::ExpressionVisitor
         ( StatementVisitor&  s
-        , clang::ASTContext& c ) :
+        , clang::ASTContext& c
+        , Arena&             a
+        , TypePool&          t
+        , DiagnosticSink&    d ) :
         statementer_ (&s),
-        context_     (&c)
+        context_     (&c),
+        arena_       (&a),
+        types_       (&t),
+        diagnostics_ (&d)
+    {
+    }
+
+    auto ExpressionVisitor::arena
+        () -> Arena&
+    {
+        return *arena_;
+    }
+
+    auto ExpressionVisitor::types
+        () -> TypePool&
     {
+        return *types_;
+    }
+
+    auto ExpressionVisitor::diagnostics
+        () -> DiagnosticSink&
+    {
+        return *diagnostics_;
     }
 
     auto ExpressionVisitor::read_expression
-        (clang::Stmt* const s) -> uptr<Expression>
+        (clang::Stmt* const s) -> Expression*
     {
         this->TraverseStmt(s);
-        if (expression_)
+        return this->take_expression(s);
+    }
+
+    auto ExpressionVisitor::read_expressions
+        (clang::Stmt* const s) -> args_t
+    {
+        this->TraverseStmt(s);
+        if (is_list(pending_))
         {
-            return std::move(expression_);
+            auto es = args_t();
+            for (auto const e : operands_of(std::exchange(pending_, nullptr)))
+            {
+                es.push_back(this->read_expression(e));
+            }
+            return es;
         }
-        else if (not expressions_.empty()) // Might have been parenlist
+        return expression_ or pending_ ? args_t {this->take_expression(s)} : args_t();
+    }
+
+    auto ExpressionVisitor::take_expression
+        (clang::Stmt* const s) -> Expression*
+    {
+        struct Task
+        {
+            clang::Stmt* node_;
+            bool         build_;
+        };
+
+        // Operands are traversed in order and their expressions are stacked,
+        // pending node is built from them once all of them are done.
+        auto tasks      = std::vector<Task>();
+        auto operands   = std::vector<Expression*>();
+        auto const take = [this, &tasks, &operands](clang::Stmt* const node)
         {
-            // TODO VarDef by mala bať vector init expressionov, lebo to môže byť aj paren list
-            auto ret = std::move(expressions_.front());
-            expressions_.clear();
-            return ret;
+            if (auto const composite = std::exchange(pending_, nullptr))
+            {
+                tasks.push_back(Task {composite, true});
+                auto const children = operands_of(composite);
+                for (auto it = children.rbegin(); it != children.rend(); ++it)
+                {
+                    tasks.push_back(Task {*it, false});
+                }
+            }
+            else
+            {
+                operands.emplace_back(this->take_handled(node));
+            }
+        };
+
+        take(s);
+        while (not tasks.empty())
+        {
+            auto const task = tasks.back();
+            tasks.pop_back();
+            if (task.build_)
+            {
+                this->build_composite(task.node_, operands);
+            }
+            else
+            {
+                this->TraverseStmt(task.node_);
+                take(task.node_);
+            }
+        }
+        return std::move(operands.back());
+    }
+
+    auto ExpressionVisitor::take_handled
+        (clang::Stmt* const s) -> Expression*
+    {
+        if (expression_)
+        {
+            return std::exchange(expression_, nullptr);
         }
         else
         {
-                std::cout << "## Unknown expression:" << '\n';
-                s->dump();
-            return std::make_unique<StringLiteral>("<unknown expression>");
+            diagnostics_->unknown_expression(s);
+            return arena_->make<StringLiteral>(arena_->intern("<unknown expression>"));
         }
     }
 
-    auto ExpressionVisitor::read_expressions
-        (clang::Stmt* const s) -> std::vector<uptr<Expression>>
+    auto ExpressionVisitor::build_composite
+        (clang::Stmt* const s, std::vector<Expression*>& operands) -> void
     {
-        expressions_ = std::vector<uptr<Expression>>();
-        this->TraverseStmt(s);
-        if (expression_)
+        auto const pop = [&operands]()
         {
-            expressions_.emplace_back(std::move(expression_));
+            auto e = std::move(operands.back());
+            operands.pop_back();
+            return e;
+        };
+
+        if (auto const b = clang::dyn_cast<clang::BinaryOperator>(s))
+        {
+            auto rhs = pop();
+            auto lhs = pop();
+            operands.emplace_back(make_binary(lhs, switch_bin_operator(b->getOpcode()), rhs, *arena_));
+        }
+        else if (auto const uo = clang::dyn_cast<clang::UnaryOperator>(s))
+        {
+            operands.emplace_back(arena_->make<UnaryOperator>(switch_un_operator(uo->getOpcode()), pop()));
+        }
+        else if (clang::isa<clang::ParenExpr>(s))
+        {
+            operands.emplace_back(arena_->make<Parenthesis>(pop()));
+        }
+        else if (clang::isa<clang::ConditionalOperator>(s))
+        {
+            auto fals = pop();
+            auto tru  = pop();
+            auto cond = pop();
+            operands.emplace_back(arena_->make<IfExpression>(std::move(cond), std::move(tru), std::move(fals)));
+        }
+        else if (auto const m = clang::dyn_cast<clang::MemberExpr>(s))
+        {
+            auto base = m->isImplicitAccess() ? arena_->make<This>() : pop();
+            operands.emplace_back(arena_->make<MemberVarRef>(std::move(base), arena_->intern(m->getMemberNameInfo().getAsString())));
+        }
+        else if (auto const r = clang::dyn_cast<clang::CXXDependentScopeMemberExpr>(s))
+        {
+            auto base = r->isImplicitAccess() ? arena_->make<This>() : pop();
+            operands.emplace_back(arena_->make<MemberVarRef>(std::move(base), arena_->intern(r->getMemberNameInfo().getAsString())));
+        }
+        else if (clang::isa<clang::UnaryExprOrTypeTraitExpr>(s))
+        {
+            operands.emplace_back(arena_->make<UnaryOperator>(UnOpcode::Unknown, pop()));
+        }
+        else if (is_list(s))
+        {
+            // Inside of other expression the list stands for its first expression.
+            auto es = take_args(operands, operands_of(s).size());
+            operands.emplace_back(es[0]);
+        }
+        else if (auto const uc = clang::dyn_cast<clang::CXXUnresolvedConstructExpr>(s))
+        {
+            auto args = take_args(operands, operands_of(s).size());
+            operands.emplace_back(arena_->make<ConstructorCall>(extract_type(context_->getPrintingPolicy(), uc->getType(), *this), std::move(args)));
+        }
+        else if (auto const n = clang::dyn_cast<clang::CXXNewExpr>(s))
+        {
+            auto args     = take_args(operands, operands_of(s).size());
+            auto const pt = n->getType()->getAs<clang::PointerType>()->getPointeeType();
+            operands.emplace_back(arena_->make<New>(extract_type(context_->getPrintingPolicy(), pt, *this), std::move(args)));
+        }
+        else if (auto const c = clang::dyn_cast<clang::CallExpr>(s))
+        {
+            // Je tu trochu technický problém lebo void(...) funkcie nie sú po správnosti Expression.
+            // Budeme sa ale tváriť, že namiesto void vracajú unit...
+            auto const callee = c->child_begin() != c->child_end() ? *c->child_begin() : nullptr;
+            switch (call_form(c))
+            {
+                case CallForm::Assign:
+                {
+                    auto const notGood = [this]()
+                    {
+                        return arena_->make<VarRef>(arena_->intern("<not good>"));
+                    };
+                    auto rhs = c->getNumArgs() > 1 ? pop() : notGood();
+                    auto lhs = c->getNumArgs() > 0 ? pop() : notGood();
+                    operands.emplace_back(arena_->make<BinaryOperator>(std::move(lhs), BinOpcode::Assign, std::move(rhs)));
+                    break;
+                }
+
+                case CallForm::Destructor:
+                    operands.emplace_back(arena_->make<DestructorCall>(pop()));
+                    break;
+
+                case CallForm::Member:
+                {
+                    auto args = take_args(operands, c->getNumArgs());
+                    auto base = member_base(callee) ? pop() : arena_->make<This>();
+                    operands.emplace_back(arena_->make<MemberFunctionCall>(std::move(base), arena_->intern(callee_name(callee)), std::move(args)));
+                    break;
+                }
+
+                case CallForm::Expression:
+                {
+                    auto args = take_args(operands, c->getNumArgs());
+                    operands.emplace_back(arena_->make<ExpressionCall>(pop(), std::move(args)));
+                    break;
+                }
+
+                case CallForm::Function:
+                case CallForm::Unknown:
+                {
+                    auto args = take_args(operands, c->getNumArgs());
+                    operands.emplace_back(arena_->make<FunctionCall>(arena_->intern(callee_name(callee)), std::move(args)));
+                    break;
+                }
+
+                case CallForm::None:
+                    break;
+            }
         }
-        return std::vector<uptr<Expression>>(std::move(expressions_));
     }
 
     auto ExpressionVisitor::VisitIntegerLiteral
         (clang::IntegerLiteral* const i) -> bool
     {
-        expression_ = std::make_unique<IntLiteral>(i->getValue().getSExtValue());
+        expression_ = arena_->make<IntLiteral>(i->getValue().getSExtValue());
         return false;
     }
 
     auto ExpressionVisitor::VisitFloatingLiteral
         (clang::FloatingLiteral* const f) -> bool
     {
-        expression_ = std::make_unique<FloatLiteral>(f->getValue().convertToDouble());
+        expression_ = arena_->make<FloatLiteral>(f->getValue().convertToDouble());
         return false;
     }
 
     auto ExpressionVisitor::VisitCXXBoolLiteralExpr
         (clang::CXXBoolLiteralExpr* const b) -> bool
     {
-        expression_ = std::make_unique<BoolLiteral>(b->getValue());
+        expression_ = arena_->make<BoolLiteral>(b->getValue());
         return false;
     }
 
     auto ExpressionVisitor::VisitParenExpr
         (clang::ParenExpr* const p) -> bool
     {
-        expression_ = std::make_unique<Parenthesis>(this->read_expression(p->getSubExpr()));
+        pending_ = p;
         return false;
     }
 
     auto ExpressionVisitor::VisitParenListExpr
         (clang::ParenListExpr* es) -> bool
     {
-        for (auto const e : es->exprs())
+        if (es->getNumExprs() > 0)
         {
-            expressions_.emplace_back(this->read_expression(e));
+            pending_ = es;
         }
         return false;
     }
@@ -89,9 +555,9 @@ namespace fri
     auto ExpressionVisitor::VisitCXXConstructExpr
         (clang::CXXConstructExpr* es) -> bool
     {
-        for (auto const e : es->arguments())
+        if (es->getNumArgs() > 0)
         {
-            expressions_.emplace_back(this->read_expression(e));
+            pending_ = es;
         }
         return false;
     }
@@ -99,57 +565,37 @@ namespace fri
     auto ExpressionVisitor::VisitBinaryOperator
         (clang::BinaryOperator* const b) -> bool
     {
-        auto lhs = this->read_expression(b->getLHS());
-        auto rhs = this->read_expression(b->getRHS());
-        auto const op = switch_bin_operator(b->getOpcode());
-        expression_ = std::make_unique<BinaryOperator>(std::move(lhs), op, std::move(rhs));
+        pending_ = b;
         return false;
     }
 
     auto ExpressionVisitor::VisitDeclRefExpr
         (clang::DeclRefExpr* const r) -> bool
     {
-        expression_ = std::make_unique<VarRef>(r->getNameInfo().getAsString());
+        expression_ = arena_->make<VarRef>(arena_->intern(r->getNameInfo().getAsString()));
         return false;
     }
 
     auto ExpressionVisitor::VisitCXXDependentScopeMemberExpr
         (clang::CXXDependentScopeMemberExpr* const r) -> bool
     {
-        auto base   = r->isImplicitAccess() ? std::make_unique<This>() : this->read_expression(r->getBase());
-        expression_ = std::make_unique<MemberVarRef>( std::move(base)
-                                                    , r->getMemberNameInfo().getAsString() );
+        pending_ = r;
         return false;
     }
 
     auto ExpressionVisitor::VisitMemberExpr
         (clang::MemberExpr* const m) -> bool
     {
-        auto base = m->isImplicitAccess() ? std::make_unique<This>() : this->read_expression(m->getBase());
-        expression_ = std::make_unique<MemberVarRef>(std::move(base), m->getMemberNameInfo().getAsString());
+        pending_ = m;
         return false;
     }
 
     auto ExpressionVisitor::VisitCXXNewExpr
         (clang::CXXNewExpr* const n) -> bool
     {
-        auto const tp = n->getType().getTypePtr();
-        if (tp->isPointerType())
+        if (n->getType().getTypePtr()->isPointerType())
         {
-            auto argsVec    = std::vector<uptr<Expression>>();
-            auto const pt   = tp->getAs<clang::PointerType>()->getPointeeType();
-
-            for (auto const arg : n->children())
-            {
-                if (auto const list = clang::dyn_cast<clang::ParenListExpr>(arg))
-                {
-                    for (auto const c : list->children())
-                    {
-                        argsVec.emplace_back(this->read_expression(c));
-                    }
-                }
-            }
-            expression_ = std::make_unique<New>(extract_type(context_->getPrintingPolicy(), pt, *this), std::move(argsVec));
+            pending_ = n;
         }
         // TODO placement new args
 
@@ -159,19 +605,14 @@ namespace fri
     auto ExpressionVisitor::VisitUnaryOperator
         (clang::UnaryOperator* const uo) -> bool
     {
-        auto const op = switch_un_operator(uo->getOpcode());
-        auto exp      = this->read_expression(uo->getSubExpr());
-        expression_   = std::make_unique<UnaryOperator>(op, std::move(exp));
+        pending_ = uo;
         return false;
     }
 
     auto ExpressionVisitor::VisitCompoundAssignOperator
         (clang::CompoundAssignOperator* const ca) -> bool
     {
-        auto const op = switch_bin_operator(ca->getOpcode());
-        auto lhs      = this->read_expression(ca->getLHS());
-        auto rhs      = this->read_expression(ca->getRHS());
-        expression_   = std::make_unique<BinaryOperator>(std::move(lhs), op, std::move(rhs));
+        pending_ = ca;
         return false;
     }
 
@@ -181,11 +622,11 @@ namespace fri
         if (uo->isArgumentType())
         {
             // TODO Zatiaľ neviem ako zistiť, že je to naozaj sizeof..., ale iné asi nepoužívame
-            expression_ = std::make_unique<UnaryOperator>(UnOpcode::Sizeof, extract_type(context_->getPrintingPolicy(), uo->getArgumentType(), *this));
+            expression_ = arena_->make<UnaryOperator>(UnOpcode::Sizeof, extract_type(context_->getPrintingPolicy(), uo->getArgumentType(), *this));
         }
         else
         {
-            expression_ = std::make_unique<UnaryOperator>(UnOpcode::Unknown, this->read_expression(uo->getArgumentExpr()));
+            pending_ = uo;
         }
         return false;
     }
@@ -193,165 +634,54 @@ namespace fri
     auto ExpressionVisitor::VisitCXXNullPtrLiteralExpr
         (clang::CXXNullPtrLiteralExpr* const) -> bool
     {
-        expression_ = std::make_unique<NullLiteral>();
+        expression_ = arena_->make<NullLiteral>();
         return false;
     }
 
     auto ExpressionVisitor::VisitCXXThisExpr
         (clang::CXXThisExpr* const) -> bool
     {
-        expression_ = std::make_unique<This>();
+        expression_ = arena_->make<This>();
         return false;
     }
 
     auto ExpressionVisitor::VisitCallExpr
         (clang::CallExpr* const c) -> bool
     {
-        // Je tu trochu technický problém lebo void(...) funkcie nie sú po správnosti Expression.
-        // Budeme sa ale tváriť, že namiesto void vracajú unit...
-
-        // TODO to private static method
-        auto const make_args = [this](auto&& as)
+        if (call_form(c) != CallForm::None)
         {
-            auto args = std::vector<uptr<Expression>>();
-            for (auto const arg : as)
-            {
-                args.emplace_back(this->read_expression(arg));
-            }
-            return args;
-        };
-
-        if (auto const o = clang::dyn_cast<clang::CXXOperatorCallExpr>(c))
-        {
-            if (o->getOperator() == clang::OverloadedOperatorKind::OO_Equal) // TODO is infix
-            {
-                auto lhs    = o->getNumArgs() > 0 ? this->read_expression(o->getArg(0)) : std::make_unique<VarRef>("<not good>");
-                auto rhs    = o->getNumArgs() > 1 ? this->read_expression(o->getArg(1)) : std::make_unique<VarRef>("<not good>");
-                expression_ = std::make_unique<BinaryOperator>(std::move(lhs), BinOpcode::Assign, std::move(rhs));
-            }
-            return false;
+            pending_ = c;
         }
-
-        auto fc = c->child_begin();
-        if (fc != c->child_end())
-        {
-            if (auto const d = clang::dyn_cast<clang::CXXPseudoDestructorExpr>(*fc))
-            {
-                expression_ = std::make_unique<DestructorCall>(this->read_expression(d->getBase()));
-            }
-            else if (auto const um = clang::dyn_cast<clang::UnresolvedMemberExpr>(*fc))
-            {
-                auto base   = um->isImplicitAccess() ? std::make_unique<This>() : this->read_expression(um->getBase());
-                auto name   = um->getMemberNameInfo().getAsString();
-                auto args   = make_args(c->arguments());
-                expression_ = std::make_unique<MemberFunctionCall>(std::move(base), std::move(name), std::move(args));
-            }
-            else if (auto const m = clang::dyn_cast<clang::MemberExpr>(*fc))
-            {
-                auto base   = m->isImplicitAccess() ? std::make_unique<This>() : this->read_expression(m->getBase());
-                auto name   = m->getMemberNameInfo().getAsString();
-                auto args   = make_args(c->arguments());
-                expression_ = std::make_unique<MemberFunctionCall>(std::move(base), std::move(name), std::move(args));
-            }
-            else if (auto const unr = clang::dyn_cast<clang::UnresolvedLookupExpr>(*fc))
-            {
-                auto name   = unr->getName().getAsString();
-                expression_ = std::make_unique<FunctionCall>(std::move(name), make_args(c->arguments()));
-            }
-            else if (auto const dm = clang::dyn_cast<clang::CXXDependentScopeMemberExpr>(*fc))
-            {
-                auto base   = dm->isImplicitAccess() ? std::make_unique<This>() : this->read_expression(dm->getBase());
-                auto name   = dm->getMemberNameInfo().getAsString();
-                auto args   = make_args(c->arguments());
-                expression_ = std::make_unique<MemberFunctionCall>(std::move(base), std::move(name), std::move(args));
-            }
-            else if (auto const v = clang::dyn_cast<clang::DeclRefExpr>(*fc))
-            {
-                if (clang::isa<clang::FunctionProtoType>(v->getType()))
-                {
-                    expression_ = std::make_unique<FunctionCall>(v->getNameInfo().getAsString(), make_args(c->arguments()));
-                }
-                else
-                {
-                    expression_ = std::make_unique<ExpressionCall>(this->read_expression(*fc), make_args(c->arguments()));
-                }
-            }
-            else if (auto const ic = clang::dyn_cast<clang::ImplicitCastExpr>(*fc))
-            {
-                auto const subExpr = ic->getSubExpr();
-                if (subExpr)
-                {
-                    auto name = [subExpr]()
-                    {
-                        if (auto const dre = clang::dyn_cast<clang::DeclRefExpr>(subExpr))
-                        {
-                            return dre->getNameInfo().getName().getAsString();
-                        }
-                        else
-                        {
-                            return std::string("<unknown name>");
-                        }
-                    }();
-                    if (auto const f = clang::dyn_cast<clang::FunctionProtoType>(subExpr->getType().getTypePtr()))
-                    {
-                        expression_ = std::make_unique<FunctionCall>(std::move(name), make_args(c->arguments()));
-                    }
-                }
-                else
-                {
-                    expression_ = std::make_unique<FunctionCall>("<unknown call type>", make_args(c->arguments()));
-                }
-            }
-            else
-            {
-                expression_ = std::make_unique<FunctionCall>("<unknown call type>", make_args(c->arguments()));
-            }
-        }
-
         return false;
     }
 
     auto ExpressionVisitor::VisitConditionalOperator
         (clang::ConditionalOperator* const c) -> bool
     {
-        expression_ = std::make_unique<IfExpression>( this->read_expression(c->getCond())
-                                                    , this->read_expression(c->getTrueExpr())
-                                                    , this->read_expression(c->getFalseExpr()) );
+        pending_ = c;
         return false;
     }
 
     auto ExpressionVisitor::VisitCXXUnresolvedConstructExpr
         (clang::CXXUnresolvedConstructExpr* const c) -> bool
     {
-        auto const make_args = [this](auto&& as)
-        {
-            auto args = std::vector<uptr<Expression>>();
-            for (auto const arg : as)
-            {
-                args.emplace_back(this->read_expression(arg));
-            }
-            return args;
-        };
- 
-        expression_ = std::make_unique<ConstructorCall>( extract_type(context_->getPrintingPolicy(), c->getType(), *this)
-                                                       , make_args(c->arguments()) );
+        pending_ = c;
         return false;
     }
 
     auto ExpressionVisitor::VisitLambdaExpr
         (clang::LambdaExpr* l) -> bool
     {
-        statementer_->TraverseStmt(l->getBody());
-        auto body = statementer_->release_compound();
+        auto body = statementer_->read_compound(l->getBody());
         if (body)
         {
-            auto params = std::vector<ParamDefinition>();
+            auto params = params_t();
             for (auto const p : l->getCallOperator()->parameters())
             {
-                params.emplace_back(extract_type(context_->getPrintingPolicy(), p->getType(), *this), p->getNameAsString());
+                params.emplace_back(extract_type(context_->getPrintingPolicy(), p->getType(), *this), arena_->intern(p->getNameAsString()));
             }
-            expression_ = std::make_unique<Lambda>( std::move(params)
-                                                  , std::move(*body) );
+            expression_ = arena_->make<Lambda>( std::move(params)
+                                              , std::move(*body) );
         }
         return false;
     }
@@ -359,7 +689,7 @@ namespace fri
     auto ExpressionVisitor::VisitStringLiteral
         (clang::StringLiteral* s) -> bool
     {
-        expression_ = std::make_unique<StringLiteral>(s->getString().str());
+        expression_ = arena_->make<StringLiteral>(arena_->intern(s->getString()));
         return false;
     }
 }
\ No newline at end of file
@@ -4,7 +4,10 @@
 #include "types.hpp"
 #include "clang/AST/RecursiveASTVisitor.h"
 #include "abstract_code.hpp"
+#include "clang_diagnostics.hpp"
+#include "type_pool.hpp"
 #include <memory>
+#include <vector>
 
 namespace fri
 {
@@ -13,10 +16,13 @@ namespace fri
     class ExpressionVisitor : public clang::RecursiveASTVisitor<ExpressionVisitor>
     {
     public:
-        ExpressionVisitor (StatementVisitor&, clang::ASTContext&);
+        ExpressionVisitor (StatementVisitor&, clang::ASTContext&, Arena&, TypePool&, DiagnosticSink&);
 
-        auto read_expression  (clang::Stmt*) -> uptr<Expression>;
-        auto read_expressions (clang::Stmt*) -> std::vector<uptr<Expression>>;
+        auto arena            ()             -> Arena&;
+        auto types            ()             -> TypePool&;
+        auto diagnostics      ()             -> DiagnosticSink&;
+        auto read_expression  (clang::Stmt*) -> Expression*;
+        auto read_expressions (clang::Stmt*) -> args_t;
 
         auto VisitIntegerLiteral              (clang::IntegerLiteral*)              -> bool;
         auto VisitFloatingLiteral             (clang::FloatingLiteral*)             -> bool;
@@ -41,10 +47,34 @@ namespace fri
         auto VisitStringLiteral               (clang::StringLiteral*)               -> bool;
 
     private:
-        uptr<Expression>              expression_;
-        std::vector<uptr<Expression>> expressions_;
-        StatementVisitor*                        statementer_;
-        clang::ASTContext*                       context_;
+        /**
+         *  @brief Takes expression of @p s after it was traversed.
+         *  Operators, parentheses, member accesses, calls, constructions
+         *  and lists are only recorded by their visits and are built here
+         *  using an explicit stack, so that long operator chains and deeply
+         *  nested arguments do not exhaust the call stack.
+         */
+        auto take_expression (clang::Stmt*) -> Expression*;
+
+        /**
+         *  @brief Replaces expressions of operands of @p s on top of
+         *  the operand stack with the expression of @p s .
+         */
+        auto build_composite (clang::Stmt*, std::vector<Expression*>&) -> void;
+
+        /**
+         *  @brief Takes expression of @p s that was built by its visit.
+         */
+        auto take_handled (clang::Stmt*) -> Expression*;
+
+    private:
+        Expression*        expression_ {nullptr};
+        clang::Stmt*       pending_    {nullptr};
+        StatementVisitor*  statementer_;
+        clang::ASTContext* context_;
+        Arena*             arena_;
+        TypePool*          types_;
+        DiagnosticSink*    diagnostics_;
     };
 }
 
@@ -2,13 +2,29 @@
 
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/RecursiveASTVisitor.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Frontend/ASTUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendAction.h"
+#include "clang/Frontend/FrontendActions.h"
+#include "clang/Frontend/TextDiagnosticPrinter.h"
+#include "clang/Frontend/Utils.h"
+#include "clang/Lex/Preprocessor.h"
+#include "clang/Tooling/ArgumentsAdjusters.h"
+#include "clang/Tooling/CompilationDatabase.h"
 #include "clang/Tooling/Tooling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/VirtualFileSystem.h"
 
 #include "clang_expression_visitor.hpp"
 #include "clang_statement_visitor.hpp"
 #include "clang_class_visitor.hpp"
+#include "clang_ast_cache.hpp"
+#include "clang_diagnostics.hpp"
+#include "file_manifest.hpp"
+#include "namespace_trie.hpp"
+#include "utils.hpp"
 
 #include <vector>
 #include <unordered_map>
@@ -16,9 +32,24 @@
 #include <iostream>
 #include <cassert>
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <sstream>
+#include <thread>
 
 namespace fri
 {
+    /**
+     *  @brief Receives unit extracted from a file with given (real) path.
+     */
+    using class_sink_t = std::function<void (std::string const&, TranslationUnit)>;
+
+    /**
+     *  @brief Receives (real) path of a file for which clang rejected the precompiled header.
+     */
+    using rejection_sink_t = std::function<void (std::string const&)>;
+
     /**
      *  @brief Handles translation unit from clang.
      */
@@ -26,12 +57,27 @@ namespace fri
     {
     public:
         explicit FindClassConsumer ( clang::ASTContext& context
-                                   , std::vector<std::unique_ptr<Class>>& classes
-                                   , std::vector<std::string> const& namespaces );
+                                   , ExtractOptions const& options
+                                   , std::string file
+                                   , class_sink_t const& sink );
         virtual auto HandleTranslationUnit (clang::ASTContext& context) -> void;
 
+        /**
+         *  @brief Skips bodies of functions that are not in our namespaces,
+         *  they are never extracted, or all bodies if only the outline
+         *  is extracted. Used only if the frontend option SkipFunctionBodies is set.
+         */
+        auto shouldSkipFunctionBody (clang::Decl* decl) -> bool override;
+
     private:
-        ClassVisitor visitor_;
+        std::unique_ptr<Arena> arena_;
+        std::vector<Class*>    classes_;
+        DiagnosticSink         diagnostics_;
+        ClassVisitor           visitor_;
+        NamespaceTrie          namespaces_;
+        bool                   outline_;
+        std::string            file_;
+        class_sink_t const*    sink_;
     };
 
     /**
@@ -40,21 +86,99 @@ namespace fri
     class FindClassAction : public clang::ASTFrontendAction
     {
     public:
-        explicit FindClassAction (std::vector<std::unique_ptr<Class>>& classes, std::vector<std::string> const& namespaces);
+        /**
+         *  @param rejected Notified if clang rejects the precompiled header, may be null.
+         */
+        FindClassAction ( ExtractOptions const&   options
+                        , class_sink_t const&     sink
+                        , rejection_sink_t const* rejected );
         virtual auto CreateASTConsumer (clang::CompilerInstance& compiler, llvm::StringRef) -> std::unique_ptr<clang::ASTConsumer>;
 
+    protected:
+        auto BeginInvocation (clang::CompilerInstance& compiler) -> bool override;
+
     private:
-        std::vector<std::unique_ptr<Class>>* classes_;
-        std::vector<std::string> const*      namespaces_;
+        ExtractOptions const*   options_;
+        class_sink_t const*     sink_;
+        rejection_sink_t const* rejected_;
+    };
+
+    /**
+     *  @brief Creates our action for each file processed by a clang tool.
+     */
+    class FindClassActionFactory : public clang::tooling::FrontendActionFactory
+    {
+    public:
+        FindClassActionFactory (ExtractOptions const& options, class_sink_t sink, rejection_sink_t rejected);
+        auto create () -> std::unique_ptr<clang::FrontendAction> override;
+
+    private:
+        ExtractOptions const* options_;
+        class_sink_t          sink_;
+        rejection_sink_t      rejected_;
+    };
+
+    /**
+     *  @brief Generates a precompiled header and records files it was built from.
+     */
+    class BuildPchAction : public clang::GeneratePCHAction
+    {
+    public:
+        BuildPchAction (std::string pchPath, std::vector<std::string>& dependencies);
+
+    protected:
+        auto BeginSourceFileAction (clang::CompilerInstance& compiler) -> bool override;
+        auto EndSourceFileAction () -> void override;
+
+    private:
+        std::string               pchPath_;
+        std::vector<std::string>* dependencies_;
+    };
+
+    /**
+     *  @brief Creates @c BuildPchAction for the header processed by a clang tool.
+     */
+    class BuildPchActionFactory : public clang::tooling::FrontendActionFactory
+    {
+    public:
+        BuildPchActionFactory (std::string pchPath, std::vector<std::string>& dependencies);
+        auto create () -> std::unique_ptr<clang::FrontendAction> override;
+
+    private:
+        std::string               pchPath_;
+        std::vector<std::string>* dependencies_;
+    };
+
+    /**
+     *  @brief Runs preprocessor only and hashes the resulting tokens.
+     */
+    class HashTokensAction : public clang::PreprocessorFrontendAction
+    {
+    public:
+        explicit HashTokensAction (std::uint64_t& hash);
+
+    protected:
+        auto ExecuteAction () -> void override;
+
+    private:
+        std::uint64_t* hash_;
     };
 
 // FindClassConsumer definitions:
 
     FindClassConsumer::FindClassConsumer
         ( clang::ASTContext& context
-        , std::vector<std::unique_ptr<Class>>& classes
-        , std::vector<std::string> const& namespaces ) :
-        visitor_ (context, classes, namespaces)
+        , ExtractOptions const& options
+        , std::string file
+        , class_sink_t const& sink ) :
+        arena_       (std::make_unique<Arena>()),
+        classes_     (),
+        diagnostics_ (context.getSourceManager(), options.verbose),
+        visitor_     (context, classes_, *arena_, options, diagnostics_),
+        namespaces_  (options.namespaces),
+        outline_     (options.outline),
+        file_        (std::move(file)),
+        sink_        (&sink)
     {
     }
 
@@ -62,32 +186,806 @@ namespace fri
         (clang::ASTContext& context) -> void
     {
         visitor_.TraverseDecl(context.getTranslationUnitDecl());
+        visitor_.extract_bodies();
+        if (not diagnostics_.empty())
+        {
+            // Written at once, units may be extracted concurrently.
+            auto ost = std::ostringstream();
+            ost << "Constructs that were not extracted from " << file_ << ":" << '\n';
+            diagnostics_.print(ost);
+            std::cerr << ost.str();
+        }
+        (*sink_)(file_, TranslationUnit(std::move(arena_), std::move(classes_)));
+    }
+
+    auto FindClassConsumer::shouldSkipFunctionBody
+        (clang::Decl* decl) -> bool
+    {
+        if (outline_)
+        {
+            return true;
+        }
+
+        // Semantic parents, so that out-of-line methods belong to their class.
+        auto path = llvm::SmallVector<clang::NamespaceDecl const*, 8>();
+        for (auto context = decl->getDeclContext(); context; context = context->getParent())
+        {
+            if (auto const namespaceDecl = clang::dyn_cast<clang::NamespaceDecl>(context))
+            {
+                path.push_back(namespaceDecl);
+            }
+        }
+
+        auto node = NamespaceTrie::Root;
+        for (auto it = path.rbegin(); it != path.rend() and not namespaces_.is_complete(node); ++it)
+        {
+            auto const name = (*it)->getName();
+            auto const next = namespaces_.child(node, std::string_view(name.data(), name.size()));
+            if (not next)
+            {
+                return true;
+            }
+            node = *next;
+        }
+        return not namespaces_.is_complete(node);
     }
 
 // FindClassAction definitions:
 
     FindClassAction::FindClassAction
-        (std::vector<std::unique_ptr<Class>>& classes, std::vector<std::string> const& namespaces) :
-        classes_    (&classes),
-        namespaces_ (&namespaces)
+        ( ExtractOptions const&         options
+        , class_sink_t const&           sink
+        , rejection_sink_t const* const rejected ) :
+        options_  (&options),
+        sink_     (&sink),
+        rejected_ (rejected)
+    {
+    }
+
+    auto FindClassAction::BeginInvocation
+        (clang::CompilerInstance& compiler) -> bool
     {
+        // Most warnings are about code that is never rendered.
+        if (not options_->verbose)
+        {
+            report_errors_only(compiler.getDiagnostics());
+        }
+
+        auto const& inputs = compiler.getFrontendOpts().Inputs;
+        if (rejected_ and not options_->pch.empty() and not inputs.empty() and inputs.front().isFile())
+        {
+            // Header is loaded before the consumer knows the real path.
+            auto realPath = llvm::SmallString<256>();
+            if (llvm::sys::fs::real_path(inputs.front().getFile(), realPath))
+            {
+                realPath = inputs.front().getFile();
+            }
+            report_pch_rejection(compiler.getDiagnostics(), [sink = rejected_, file = realPath.str().str()]()
+            {
+                (*sink)(file);
+            });
+        }
+        return true;
     }
 
     auto FindClassAction::CreateASTConsumer
-        (clang::CompilerInstance& compiler, llvm::StringRef) -> std::unique_ptr<clang::ASTConsumer>
+        (clang::CompilerInstance& compiler, llvm::StringRef inFile) -> std::unique_ptr<clang::ASTConsumer>
+    {
+        // Bodies are skipped by the consumer, only those we extract are parsed.
+        compiler.getFrontendOpts().SkipFunctionBodies = true;
+
+        // Tool may change the working directory, real path identifies the file reliably.
+        auto realPath = llvm::SmallString<256>();
+        if (compiler.getFileManager().getVirtualFileSystem().getRealPath(inFile, realPath))
+        {
+            realPath = inFile;
+        }
+        return std::make_unique<FindClassConsumer>(compiler.getASTContext(), *options_, realPath.str().str(), *sink_);
+    }
+
+// FindClassActionFactory definitions:
+
+    FindClassActionFactory::FindClassActionFactory
+        (ExtractOptions const& options, class_sink_t sink, rejection_sink_t rejected) :
+        options_  (&options),
+        sink_     (std::move(sink)),
+        rejected_ (std::move(rejected))
+    {
+    }
+
+    auto FindClassActionFactory::create
+        () -> std::unique_ptr<clang::FrontendAction>
+    {
+        return std::make_unique<FindClassAction>(*options_, sink_, &rejected_);
+    }
+
+// BuildPchAction definitions:
+
+    BuildPchAction::BuildPchAction
+        (std::string pchPath, std::vector<std::string>& dependencies) :
+        pchPath_      (std::move(pchPath)),
+        dependencies_ (&dependencies)
+    {
+    }
+
+    auto BuildPchAction::BeginSourceFileAction
+        (clang::CompilerInstance& compiler) -> bool
+    {
+        // Tool strips output path from the command line, it is set here instead.
+        compiler.getFrontendOpts().OutputFile = pchPath_;
+        return clang::GeneratePCHAction::BeginSourceFileAction(compiler);
+    }
+
+    auto BuildPchAction::EndSourceFileAction
+        () -> void
+    {
+        auto const files = source_files(this->getCompilerInstance().getSourceManager());
+        dependencies_->insert(std::end(*dependencies_), std::begin(files), std::end(files));
+        clang::GeneratePCHAction::EndSourceFileAction();
+    }
+
+// HashTokensAction definitions:
+
+    HashTokensAction::HashTokensAction
+        (std::uint64_t& hash) :
+        hash_ (&hash)
+    {
+    }
+
+    auto HashTokensAction::ExecuteAction
+        () -> void
+    {
+        auto& preprocessor = this->getCompilerInstance().getPreprocessor();
+        auto  token        = clang::Token();
+        auto  buffer       = llvm::SmallString<64>();
+        preprocessor.EnterMainSourceFile();
+        for (preprocessor.Lex(token); token.isNot(clang::tok::eof); preprocessor.Lex(token))
+        {
+            // Tokens are separated by null so that adjacent tokens do not merge.
+            auto const spelling = preprocessor.getSpelling(token, buffer);
+            *hash_ = fnv1a(std::string_view(spelling.data(), spelling.size()), *hash_);
+            *hash_ = fnv1a(std::string_view("", 1), *hash_);
+        }
+    }
+
+// BuildPchActionFactory definitions:
+
+    BuildPchActionFactory::BuildPchActionFactory
+        (std::string pchPath, std::vector<std::string>& dependencies) :
+        pchPath_      (std::move(pchPath)),
+        dependencies_ (&dependencies)
+    {
+    }
+
+    auto BuildPchActionFactory::create
+        () -> std::unique_ptr<clang::FrontendAction>
+    {
+        return std::make_unique<BuildPchAction>(pchPath_, *dependencies_);
+    }
+
+// Compiler argument helpers and precompiled header definitions:
+
+    namespace
+    {
+        /**
+         *  @brief Identifies args a precompiled header was built with.
+         */
+        auto args_key
+            (ExtractOptions const& options) -> std::uint64_t
+        {
+            auto key = fnv1a({});
+            for (auto const& arg : options.args)
+            {
+                key = fnv1a(std::string_view(arg.c_str(), arg.size() + 1), key);
+            }
+            return key;
+        }
+
+        /**
+         *  @brief Identifies options and compile commands of @p file
+         *  that affect its parsed AST.
+         */
+        auto ast_key
+            ( clang::tooling::CompilationDatabase const& database
+            , std::string const&                         file
+            , ExtractOptions const&                      options ) -> std::uint64_t
+        {
+            auto key = fnv1a(options.pch, args_key(options));
+            for (auto const& command : database.getCompileCommands(file))
+            {
+                key = fnv1a(std::string_view(command.Directory.c_str(), command.Directory.size() + 1), key);
+                for (auto const& arg : command.CommandLine)
+                {
+                    key = fnv1a(std::string_view(arg.c_str(), arg.size() + 1), key);
+                }
+            }
+            return key;
+        }
+
+        auto manifest_path
+            (std::string const& pchPath) -> std::string
+        {
+            return pchPath + ".deps";
+        }
+
+        /**
+         *  @brief Args from @p options along with the precompiled header.
+         */
+        auto compiler_args
+            (ExtractOptions const& options) -> std::vector<std::string>
+        {
+            auto args = options.args;
+            if (not options.pch.empty())
+            {
+                args.insert(std::end(args), {"-include-pch", options.pch});
+            }
+            return args;
+        }
+    }
+
+    auto build_pch
+        (std::string const& header, std::string const& pchPath, ExtractOptions const& options) -> bool
+    {
+        // Timestamps are not stored, content hashes are checked instead.
+        auto args = options.args;
+        args.insert(std::end(args), {"-x", "c++-header", "-Xclang", "-fno-pch-timestamp"});
+
+        auto dependencies = std::vector<std::string>();
+        auto factory      = BuildPchActionFactory(pchPath, dependencies);
+        auto database     = clang::tooling::FixedCompilationDatabase(".", args);
+        auto tool         = clang::tooling::ClangTool(database, std::vector<std::string> {header});
+        if (tool.run(&factory) != 0)
+        {
+            std::cerr << "Failed to build precompiled header: " << header << '\n';
+            return false;
+        }
+
+        auto const manifest = FileManifest::capture(args_key(options), dependencies);
+        if (not manifest or not manifest->save(manifest_path(pchPath)))
+        {
+            std::cerr << "Failed to record files of precompiled header: " << manifest_path(pchPath) << '\n';
+            return false;
+        }
+        return true;
+    }
+
+    auto is_pch_current
+        (std::string const& pchPath, ExtractOptions const& options) -> bool
     {
-        return std::make_unique<FindClassConsumer>(compiler.getASTContext(), *classes_, *namespaces_);
+        if (not std::filesystem::exists(pchPath))
+        {
+            std::cerr << "Precompiled header not found: " << pchPath << '\n';
+            return false;
+        }
+
+        auto const manifest = FileManifest::load(manifest_path(pchPath));
+        if (not manifest or not manifest->is_current(args_key(options)))
+        {
+            std::cerr << "Precompiled header is stale, parsing without it: " << pchPath << '\n';
+            return false;
+        }
+        return true;
+    }
+
+// hash_preprocessed definition:
+
+    auto hash_preprocessed
+        (std::string const& code, ExtractOptions const& options) -> std::optional<std::uint64_t>
+    {
+        // Precompiled header does not change the extracted unit, tokens
+        // of the headers are hashed instead.
+        auto hash = args_key(options);
+        for (auto const& name : options.namespaces)
+        {
+            hash = fnv1a(std::string_view(name.c_str(), name.size() + 1), hash);
+        }
+        hash = fnv1a("interfaces", hash);
+        for (auto const& name : options.interfaces.names())
+        {
+            hash = fnv1a(std::string_view(name.c_str(), name.size() + 1), hash);
+        }
+        hash = fnv1a(options.outline ? "outline" : "full", hash);
+
+        auto const ok = clang::tooling::runToolOnCodeWithArgs(std::make_unique<HashTokensAction>(hash), code, options.args);
+        return ok ? std::optional<std::uint64_t>(hash) : std::nullopt;
     }
 
 // extract_code definition:
 
     auto extract_code
-        (std::string const& code) -> TranslationUnit
+        (std::string const& code, ExtractOptions const& options) -> TranslationUnit
+    {
+        auto unit = TranslationUnit(std::make_unique<Arena>(), std::vector<Class*>());
+        auto sink = class_sink_t([&unit](auto const&, auto extracted)
+        {
+            unit = std::move(extracted);
+        });
+        clang::tooling::runToolOnCodeWithArgs(std::make_unique<FindClassAction>(options, sink, nullptr), code, compiler_args(options));
+        return unit;
+    }
+
+// CodeExtractor definitions:
+
+    struct CodeExtractor::State
+    {
+        ExtractOptions                                          options_;
+        std::vector<std::string>                                args_;
+        std::shared_ptr<clang::PCHContainerOperations>          pchOperations_;
+        llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> inputs_;
+        llvm::IntrusiveRefCntPtr<clang::FileManager>            files_;
+        std::size_t                                             count_ {0};
+    };
+
+    CodeExtractor::CodeExtractor
+        (ExtractOptions options) :
+        state_ (std::make_unique<State>())
+    {
+        state_->args_          = compiler_args(options);
+        state_->options_       = std::move(options);
+        state_->pchOperations_ = std::make_shared<clang::PCHContainerOperations>();
+    }
+
+    CodeExtractor::~CodeExtractor
+        () = default;
+
+    CodeExtractor::CodeExtractor
+        (CodeExtractor&&) noexcept = default;
+
+    auto CodeExtractor::operator=
+        (CodeExtractor&&) noexcept -> CodeExtractor& = default;
+
+    auto CodeExtractor::extract
+        (std::string const& code) -> std::optional<TranslationUnit>
+    {
+        return this->extract(code, state_->options_);
+    }
+
+    auto CodeExtractor::extract
+        (std::string const& code, ExtractOptions const& options) -> std::optional<TranslationUnit>
+    {
+        // Inputs are kept by the file system, which is thus replaced from time to time.
+        auto constexpr InputsPerFiles = std::size_t {256};
+        auto& state = *state_;
+        if (state.count_ % InputsPerFiles == 0)
+        {
+            auto overlay = llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem>(
+                new llvm::vfs::OverlayFileSystem(llvm::vfs::getRealFileSystem()) );
+            state.inputs_ = llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem>(new llvm::vfs::InMemoryFileSystem());
+            overlay->pushOverlay(state.inputs_);
+            state.files_ = llvm::IntrusiveRefCntPtr<clang::FileManager>(new clang::FileManager(clang::FileSystemOptions(), overlay));
+        }
+
+        // Each input gets its own name so that the file manager does not
+        // mistake it for a previous one.
+        auto const name = "input-" + std::to_string(state.count_++) + ".cc";
+        state.inputs_->addFile(name, 0, llvm::MemoryBuffer::getMemBufferCopy(code));
+
+        auto args = std::vector<std::string> {"clang-tool", "-fsyntax-only"};
+        args.insert(std::end(args), std::begin(state.args_), std::end(state.args_));
+        args.emplace_back(name);
+
+        auto unit = std::optional<TranslationUnit>();
+        auto sink = class_sink_t([&unit](auto const&, auto extracted)
+        {
+            unit = std::move(extracted);
+        });
+        auto invocation = clang::tooling::ToolInvocation
+            ( std::move(args)
+            , std::make_unique<FindClassAction>(options, sink, nullptr)
+            , state.files_.get()
+            , state.pchOperations_ );
+        invocation.run();
+        return unit;
+    }
+
+// CompileCommands definitions:
+
+    CompileCommands::CompileCommands
+        (std::shared_ptr<clang::tooling::CompilationDatabase> database) :
+        database_ (std::move(database))
+    {
+    }
+
+    auto CompileCommands::load
+        (std::string const& buildDir) -> std::optional<CompileCommands>
+    {
+        if (buildDir.empty())
+        {
+            return CompileCommands(clang::tooling::inferMissingCompileCommands(
+                std::make_unique<clang::tooling::FixedCompilationDatabase>(".", std::vector<std::string>()) ));
+        }
+
+        auto error    = std::string();
+        auto database = clang::tooling::CompilationDatabase::loadFromDirectory(buildDir, error);
+        if (not database)
+        {
+            std::cerr << "Failed to load compilation database: " << error << '\n';
+            return std::nullopt;
+        }
+        return CompileCommands(clang::tooling::inferMissingCompileCommands(std::move(database)));
+    }
+
+    auto CompileCommands::database
+        () const -> clang::tooling::CompilationDatabase const&
+    {
+        return *database_;
+    }
+
+// extract_codes definitions:
+
+    namespace
+    {
+        auto add_arguments
+            (clang::tooling::ClangTool& tool, ExtractOptions const& options) -> void
+        {
+            tool.appendArgumentsAdjuster(clang::tooling::getInsertArgumentAdjuster(
+                compiler_args(options), clang::tooling::ArgumentInsertPosition::END ));
+        }
+
+        /**
+         *  @brief Runs a single tool on all files. Units are identified by real paths.
+         */
+        auto extract_serial
+            ( clang::tooling::CompilationDatabase const& database
+            , std::vector<std::string> const&            files
+            , ExtractOptions const&                      options
+            , unit_handler_t const&                      handler
+            , std::vector<std::uint8_t>&                 handled
+            , std::vector<std::uint8_t>&                 rejected ) -> void
+        {
+            // Map real paths of inputs to their indices.
+            auto indices = std::unordered_map<std::string, std::size_t>();
+            for (auto i = 0u; i < files.size(); ++i)
+            {
+                auto realPath = llvm::SmallString<256>();
+                if (llvm::sys::fs::real_path(files[i], realPath))
+                {
+                    std::cerr << "Failed to resolve input file: " << files[i] << '\n';
+                    continue;
+                }
+                indices.emplace(realPath.str().str(), i);
+            }
+
+            auto factory = FindClassActionFactory(options, [&](auto const& file, auto unit)
+            {
+                auto const it = indices.find(file);
+                if (it == std::end(indices) or handled[it->second])
+                {
+                    // Either not our input or a file with multiple compile commands.
+                    return;
+                }
+                handled[it->second] = true;
+                handler(it->second, std::move(unit));
+            }, [&](auto const& file)
+            {
+                auto const it = indices.find(file);
+                if (it != std::end(indices))
+                {
+                    rejected[it->second] = true;
+                }
+            });
+
+            auto tool = clang::tooling::ClangTool(database, files);
+            add_arguments(tool, options);
+            tool.run(&factory);
+        }
+
+        /**
+         *  @brief Creates a tool for a single file. Each tool gets its own file
+         *  system so that tools can use different working directories concurrently.
+         */
+        auto single_file_tool
+            ( clang::tooling::CompilationDatabase const& database
+            , std::string const&                         file
+            , ExtractOptions const&                      options ) -> clang::tooling::ClangTool
+        {
+            auto tool = clang::tooling::ClangTool
+                ( database
+                , std::vector<std::string> {file}
+                , std::make_shared<clang::PCHContainerOperations>()
+                , llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem>(llvm::vfs::createPhysicalFileSystem()) );
+            add_arguments(tool, options);
+            return tool;
+        }
+
+        /**
+         *  @brief Runs a separate tool for each file on @p jobs threads.
+         */
+        auto extract_parallel
+            ( clang::tooling::CompilationDatabase const& database
+            , std::vector<std::string> const&            files
+            , ExtractOptions const&                      options
+            , unit_handler_t const&                      handler
+            , std::vector<std::uint8_t>&                 handled
+            , std::vector<std::uint8_t>&                 rejected
+            , unsigned const                             jobs ) -> void
+        {
+            run_parallel(files.size(), jobs, [&](std::size_t const i)
+            {
+                auto factory = FindClassActionFactory(options, [&, i](auto const&, auto unit)
+                {
+                    if (handled[i])
+                    {
+                        return;
+                    }
+                    handled[i] = true;
+                    handler(i, std::move(unit));
+                }, [&rejected, i](auto const&)
+                {
+                    rejected[i] = true;
+                });
+                auto tool = single_file_tool(database, files[i], options);
+                tool.run(&factory);
+            });
+        }
+
+        /**
+         *  @brief Extracts code from an already parsed (or loaded) @p unit .
+         */
+        auto extract_unit
+            ( clang::ASTUnit&       unit
+            , ExtractOptions const& options
+            , std::string const&    file ) -> TranslationUnit
+        {
+            auto extracted = TranslationUnit(std::make_unique<Arena>(), std::vector<Class*>());
+            auto const sink = class_sink_t([&extracted](auto const&, auto u)
+            {
+                extracted = std::move(u);
+            });
+            auto& context = unit.getASTContext();
+            auto consumer = FindClassConsumer(context, options, file, sink);
+            consumer.HandleTranslationUnit(context);
+            return extracted;
+        }
+
+        /**
+         *  @brief Extracts each file from its stored AST if it is current.
+         *  Other files are parsed and their ASTs are stored for the next run.
+         */
+        auto extract_with_cache
+            ( clang::tooling::CompilationDatabase const& database
+            , std::vector<std::string> const&            files
+            , ExtractOptions const&                      options
+            , unit_handler_t const&                      handler
+            , std::vector<std::uint8_t>&                 handled
+            , std::vector<std::uint8_t>&                 rejected
+            , unsigned const                             jobs ) -> void
+        {
+            auto const cache = AstCache(options.astCache);
+            run_parallel(files.size(), jobs, [&](std::size_t const i)
+            {
+                auto realPath = llvm::SmallString<256>();
+                if (llvm::sys::fs::real_path(files[i], realPath))
+                {
+                    std::cerr << "Failed to resolve input file: " << files[i] << '\n';
+                    return;
+                }
+
+                auto const file = realPath.str().str();
+                auto const key  = ast_key(database, file, options);
+                auto unit = cache.load(file, key);
+                if (not unit)
+                {
+                    auto units    = std::vector<std::unique_ptr<clang::ASTUnit>>();
+                    auto tool     = single_file_tool(database, file, options);
+                    auto printer  = clang::TextDiagnosticPrinter(llvm::errs(), new clang::DiagnosticOptions());
+                    auto consumer = PchDiagConsumer(&printer, nullptr, [&rejected, i]()
+                    {
+                        rejected[i] = true;
+                    });
+                    tool.setDiagnosticConsumer(&consumer);
+                    tool.buildASTs(units);
+                    if (units.empty() or not units.front())
+                    {
+                        return;
+                    }
+                    unit = std::move(units.front());
+                    cache.store(file, key, *unit);
+                }
+
+                handled[i] = true;
+                handler(i, extract_unit(*unit, options, file));
+            });
+        }
+    }
+
+    namespace
+    {
+        /**
+         *  @brief Extracts @p files in a way chosen by @p options and @p jobs .
+         *  Marks inputs that were extracted in @p handled and those for which
+         *  clang rejected the precompiled header in @p rejected .
+         */
+        auto extract_all
+            ( clang::tooling::CompilationDatabase const& database
+            , std::vector<std::string> const&            files
+            , ExtractOptions const&                      options
+            , unit_handler_t const&                      handler
+            , std::vector<std::uint8_t>&                 handled
+            , std::vector<std::uint8_t>&                 rejected
+            , unsigned const                             jobs ) -> void
+        {
+            if (not options.astCache.empty())
+            {
+                extract_with_cache(database, files, options, handler, handled, rejected, jobs);
+            }
+            else if (jobs > 1)
+            {
+                extract_parallel(database, files, options, handler, handled, rejected, jobs);
+            }
+            else
+            {
+                extract_serial(database, files, options, handler, handled, rejected);
+            }
+        }
+    }
+
+    auto extract_codes
+        ( CompileCommands const&          commands
+        , std::vector<std::string> const& files
+        , ExtractOptions const&           options
+        , unsigned const                  jobs
+        , unit_handler_t const&           handler ) -> std::vector<std::size_t>
+    {
+        auto handled  = std::vector<std::uint8_t>(files.size(), false);
+        auto rejected = std::vector<std::uint8_t>(files.size(), false);
+        extract_all(commands.database(), files, options, handler, handled, rejected, jobs);
+
+        // Precompiled header is built only with args from options. Clang
+        // rejects it for inputs whose compile commands differ, e.g. in
+        // defines or -std, such inputs are parsed once more without it.
+        // Inputs that failed for other reasons would fail again.
+        auto retried = std::vector<std::size_t>();
+        auto retries = std::vector<std::string>();
+        for (auto i = 0u; i < files.size(); ++i)
+        {
+            if (not handled[i] and rejected[i])
+            {
+                std::cerr << "Precompiled header rejected, parsing without it: " << files[i] << '\n';
+                retried.emplace_back(i);
+                retries.emplace_back(files[i]);
+            }
+        }
+
+        if (not retries.empty())
+        {
+            auto plain = options;
+            plain.pch.clear();
+            auto retriedHandled  = std::vector<std::uint8_t>(retries.size(), false);
+            auto retriedRejected = std::vector<std::uint8_t>(retries.size(), false);
+            extract_all(commands.database(), retries, plain, [&](std::size_t const i, TranslationUnit unit)
+            {
+                handler(retried[i], std::move(unit));
+            }, retriedHandled, retriedRejected, jobs);
+            for (auto i = 0u; i < retried.size(); ++i)
+            {
+                handled[retried[i]] = retriedHandled[i];
+            }
+        }
+
+        auto failed = std::vector<std::size_t>();
+        for (auto i = 0u; i < files.size(); ++i)
+        {
+            if (not handled[i])
+            {
+                failed.emplace_back(i);
+            }
+        }
+        return failed;
+    }
+
+    auto extract_file
+        (std::string const& path, ExtractOptions const& options) -> std::optional<TranslationUnit>
+    {
+        auto const commands = CompileCommands::load({});
+        auto unit = std::optional<TranslationUnit>();
+        extract_codes(*commands, {path}, options, 1, [&unit](std::size_t, TranslationUnit u)
+        {
+            unit = std::move(u);
+        });
+        return unit;
+    }
+
+// IncrementalParser definitions:
+
+    struct IncrementalParser::State
+    {
+        std::string                                    path_;
+        ExtractOptions                                 options_;
+        std::shared_ptr<clang::PCHContainerOperations> pchOperations_;
+        std::unique_ptr<clang::ASTUnit>                unit_;
+        std::vector<std::string>                       files_;
+    };
+
+    IncrementalParser::IncrementalParser
+        (std::string path, ExtractOptions options) :
+        state_ (std::make_unique<State>())
+    {
+        state_->path_          = std::move(path);
+        state_->options_       = std::move(options);
+        state_->pchOperations_ = std::make_shared<clang::PCHContainerOperations>();
+    }
+
+    IncrementalParser::~IncrementalParser
+        () = default;
+
+    IncrementalParser::IncrementalParser
+        (IncrementalParser&&) noexcept = default;
+
+    auto IncrementalParser::operator=
+        (IncrementalParser&&) noexcept -> IncrementalParser& = default;
+
+    auto IncrementalParser::extract
+        () -> std::optional<TranslationUnit>
+    {
+        auto& state  = *state_;
+        auto  buffer = llvm::MemoryBuffer::getFile(state.path_);
+        if (not buffer)
+        {
+            std::cerr << "Failed to open input file: " << state.path_ << '\n';
+            return std::nullopt;
+        }
+
+        // Unit takes ownership of remapped buffers, but only once it has
+        // a compiler invocation, which a reparsed unit always has. Until
+        // then the buffer is owned here.
+        auto content = std::move(*buffer);
+        if (not state.unit_)
+        {
+            auto args = std::vector<char const*> {"clang"};
+            for (auto const& arg : state.options_.args)
+            {
+                args.emplace_back(arg.c_str());
+            }
+            args.emplace_back(state.path_.c_str());
+
+            // Unit returns early without taking the buffer if it can not
+            // create the invocation, so that is checked first.
+            auto const quiet = clang::CompilerInstance::createDiagnostics(
+                new clang::DiagnosticOptions(), new clang::IgnoringDiagConsumer() );
+            if (not clang::createInvocationFromCommandLine(args, quiet))
+            {
+                std::cerr << "Failed to create compiler invocation: " << state.path_ << '\n';
+                return std::nullopt;
+            }
+
+            // Preamble is built by the second parse, so that the first one
+            // reports all included files. The first change is thus slower.
+            auto diagnostics = clang::CompilerInstance::createDiagnostics(new clang::DiagnosticOptions());
+            state.unit_.reset(clang::ASTUnit::LoadFromCommandLine
+                ( args.data()
+                , args.data() + args.size()
+                , state.pchOperations_
+                , diagnostics
+                , llvm::StringRef()
+                , false
+                , clang::CaptureDiagsKind::None
+                , clang::ASTUnit::RemappedFile(state.path_, content.release())
+                , true
+                , 2 ));
+            if (not state.unit_)
+            {
+                return std::nullopt;
+            }
+        }
+        else if (state.unit_->Reparse(state.pchOperations_, clang::ASTUnit::RemappedFile(state.path_, content.release())))
+        {
+            return std::nullopt;
+        }
+
+        auto const files = source_files(state.unit_->getSourceManager());
+        state.files_.insert(std::end(state.files_), std::begin(files), std::end(files));
+        std::ranges::sort(state.files_);
+        state.files_.erase(std::unique(std::begin(state.files_), std::end(state.files_)), std::end(state.files_));
+
+        return extract_unit(*state.unit_, state.options_, state.path_);
+    }
+
+    auto IncrementalParser::files
+        () const -> std::vector<std::string>
     {
-        auto cs   = std::vector<std::unique_ptr<Class>>();
-        auto args = std::vector<std::string> {"-Wno-non-pod-varargs", "-O0", "-I/usr/local/lib/clang/13.0.0/include"};
-        auto ns   = std::vector<std::string> {"mm", "adt", "amt"};
-        clang::tooling::runToolOnCodeWithArgs(std::make_unique<FindClassAction>(cs, ns), code, args);
-        return TranslationUnit(std::move(cs));
+        auto files = state_->files_;
+        files.emplace_back(state_->path_);
+        return files;
     }
-}
\ No newline at end of file
+}
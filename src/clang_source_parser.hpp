@@ -2,15 +2,220 @@
 #define FRI_CLANG_SOURCE_PARSER_HPP
 
 #include "abstract_code.hpp"
+#include "interface_names.hpp"
 
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
 #include <string>
+#include <vector>
+
+namespace clang::tooling
+{
+    class CompilationDatabase;
+}
 
 namespace fri
 {
+    /**
+     *  @brief Options that drive the extraction.
+     */
+    struct ExtractOptions
+    {
+        std::vector<std::string> args       {"-Wno-non-pod-varargs", "-O0", "-I/usr/local/lib/clang/13.0.0/include"};
+        std::vector<std::string> namespaces {"mm", "adt", "amt"};
+
+        /**
+         *  @brief Classes and types with these names are shown as interfaces.
+         */
+        InterfaceNames interfaces {};
+
+        /**
+         *  @brief Precompiled header included in each input if not empty.
+         *  Use @c is_pch_current to check that it can be used. Inputs for
+         *  which clang rejects it, e.g. because their compile commands do not
+         *  match, are parsed once more without it.
+         */
+        std::string pch {};
+
+        /**
+         *  @brief Directory with serialized ASTs of inputs if not empty.
+         *  Inputs that did not change since the last run are not parsed.
+         */
+        std::string astCache {};
+
+        /**
+         *  @brief Extract only outlines of classes. Bodies of methods,
+         *  constructors and destructors are neither parsed nor extracted.
+         */
+        bool outline {false};
+
+        /**
+         *  @brief Number of threads that extract method bodies of a single
+         *  input once it is parsed. Clang loads declarations from a
+         *  precompiled header, preamble or stored AST lazily and not thread
+         *  safely, bodies of such inputs are thus extracted on one thread.
+         */
+        unsigned bodyJobs {1};
+
+        /**
+         *  @brief Print all clang warnings and dump constructs that could not
+         *  be extracted. Otherwise only errors and a summary are printed.
+         */
+        bool verbose {false};
+    };
+
+    /**
+     *  @brief Precompiles @p header into @p pchPath using args from @p options .
+     *  Files that were used to build it are recorded next to it so that
+     *  a stale header can be detected later.
+     */
+    auto build_pch ( std::string const&    header
+                   , std::string const&    pchPath
+                   , ExtractOptions const& options ) -> bool;
+
+    /**
+     *  @brief Checks that @p pchPath exists, was built with the same args
+     *  as in @p options and that none of the files it was built from changed.
+     *  Prints the reason if it can not be used.
+     */
+    auto is_pch_current ( std::string const&    pchPath
+                        , ExtractOptions const& options ) -> bool;
+
+    /**
+     *  @brief Compile commands of the inputs. Loaded once and shared by all extractions.
+     */
+    class CompileCommands
+    {
+    public:
+        /**
+         *  @brief Loads compile_commands.json from @p buildDir . If @p buildDir
+         *  is empty, no commands are loaded. Commands for files that are not
+         *  in the database (e.g. headers) are inferred.
+         */
+        static auto load (std::string const& buildDir) -> std::optional<CompileCommands>;
+
+        auto database () const -> clang::tooling::CompilationDatabase const&;
+
+    private:
+        CompileCommands (std::shared_ptr<clang::tooling::CompilationDatabase>);
+
+    private:
+        std::shared_ptr<clang::tooling::CompilationDatabase> database_;
+    };
+
+    /**
+     *  @brief Receives translation unit extracted from the input with given index.
+     */
+    using unit_handler_t = std::function<void (std::size_t, TranslationUnit)>;
+
     /**
      *  @brief Our function that interacts with the clang black magic.
      */
-    auto extract_code (std::string const& code) -> TranslationUnit;
+    auto extract_code ( std::string const&    code
+                      , ExtractOptions const& options = ExtractOptions {} ) -> TranslationUnit;
+
+    /**
+     *  @brief Extracts code from strings repeatedly. Unlike @c extract_code
+     *  it keeps the file manager of clang between extractions, so that
+     *  headers are looked up once for many inputs. The file manager is
+     *  replaced after a number of inputs, changes of headers are noticed
+     *  only then. Each thread needs its own extractor.
+     */
+    class CodeExtractor
+    {
+    public:
+        explicit CodeExtractor (ExtractOptions options);
+        ~CodeExtractor ();
+
+        CodeExtractor (CodeExtractor&&) noexcept;
+        auto operator= (CodeExtractor&&) noexcept -> CodeExtractor&;
+
+        /**
+         *  @brief Same as @c extract_code .
+         *  @return nullopt if clang could not process @p code .
+         */
+        auto extract (std::string const& code) -> std::optional<TranslationUnit>;
+
+        /**
+         *  @brief Same as above, with @p options instead of those of the
+         *  extractor. Compiler args and the precompiled header of the
+         *  extractor are used regardless of @p options .
+         */
+        auto extract ( std::string const&    code
+                     , ExtractOptions const& options ) -> std::optional<TranslationUnit>;
+
+    private:
+        struct State;
+        std::unique_ptr<State> state_;
+    };
+
+    /**
+     *  @brief Hashes tokens of preprocessed @p code along with @p options .
+     *  Identifies the unit that would be extracted from @p code , comments
+     *  and formatting do not affect it.
+     *  @return nullopt if @p code could not be preprocessed.
+     */
+    auto hash_preprocessed ( std::string const&    code
+                           , ExtractOptions const& options ) -> std::optional<std::uint64_t>;
+
+    /**
+     *  @brief Extracts code from file at @p path . Unlike @c extract_code
+     *  it can use stored ASTs.
+     *  @return nullopt if the file could not be processed.
+     */
+    auto extract_file ( std::string const&    path
+                      , ExtractOptions const& options ) -> std::optional<TranslationUnit>;
+
+    /**
+     *  @brief Keeps a parsed input in memory between extractions. Headers
+     *  included at the beginning of the input are precompiled into a preamble,
+     *  so that only the rest of the input is parsed when it changes.
+     *  Precompiled header from the options is not used, the preamble replaces it.
+     */
+    class IncrementalParser
+    {
+    public:
+        IncrementalParser (std::string path, ExtractOptions options);
+        ~IncrementalParser ();
+
+        IncrementalParser (IncrementalParser&&) noexcept;
+        auto operator= (IncrementalParser&&) noexcept -> IncrementalParser&;
+
+        /**
+         *  @brief Parses current content of the input. The preamble is
+         *  rebuilt only if it changed or one of its headers changed.
+         *  @return nullopt if the input could not be parsed.
+         */
+        auto extract () -> std::optional<TranslationUnit>;
+
+        /**
+         *  @brief Input and all files it included so far.
+         */
+        auto files () const -> std::vector<std::string>;
+
+    private:
+        struct State;
+        std::unique_ptr<State> state_;
+    };
+
+    /**
+     *  @brief Extracts code from multiple files using a single clang tool.
+     *  @param commands compile commands of @p files , args from @p options
+     *         are appended to them.
+     *  @param jobs number of files processed concurrently. If it is greater
+     *         than one, each file gets its own tool and @p handler is called
+     *         concurrently from multiple threads. Same holds if ASTs
+     *         are stored, see @c ExtractOptions::astCache .
+     *  @param handler receives each extracted unit along with its index.
+     *  @return indices of files that could not be processed.
+     */
+    auto extract_codes ( CompileCommands const&          commands
+                       , std::vector<std::string> const& files
+                       , ExtractOptions const&           options
+                       , unsigned                        jobs
+                       , unit_handler_t const&           handler ) -> std::vector<std::size_t>;
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -1,48 +1,323 @@
 #include "clang_statement_visitor.hpp"
 #include "clang_utils.hpp"
     #include <iostream>
+#include <cstdint>
+#include <utility>
 
 namespace fri
 {
     StatementVisitor::StatementVisitor
-        (clang::ASTContext& c) :
+        (clang::ASTContext& c, Arena& a, TypePool& t, DiagnosticSink& d) :
         context_      (&c),
-        expressioner_ (*this, c)
+        arena_        (&a),
+        expressioner_ (*this, c, a, t, d)
     {
     }
 
+    namespace
+    {
+        /**
+         *  @brief What the part of a switch that was traversed last is.
+         */
+        enum class SwitchPart : std::uint8_t
+        {
+            Label,     // Statement of a case or default label.
+            Following, // Statement that follows a label.
+            CaseBody   // Compound statement of a case label.
+        };
+
+        /**
+         *  @brief Statements of which label are being read in a switch.
+         */
+        enum class SwitchGroup : std::uint8_t
+        {
+            None, Case, Default
+        };
+    }
+
+    /**
+     *  @brief State of a nested statement whose parts are being read.
+     */
+    struct StatementVisitor::Frame
+    {
+        clang::Stmt*                     node_;
+        std::size_t                      step_       {0};
+        std::vector<Statement*>          statements_ {};
+        Statement*                       init_       {nullptr};
+        Expression*                      cond_       {nullptr};
+        Expression*                      inc_        {nullptr};
+        std::optional<CompoundStatement> then_       {};
+        std::vector<Case>                cases_      {};
+        std::optional<CompoundStatement> default_    {};
+        Expression*                      case_       {nullptr};
+        SwitchPart                       part_       {};
+        SwitchGroup                      group_      {};
+    };
+
     auto StatementVisitor::release_compound
-        () -> std::unique_ptr<CompoundStatement>
+        () -> std::optional<CompoundStatement>
     {
-        return std::unique_ptr<CompoundStatement>(std::move(compound_));
+        return std::exchange(compound_, std::nullopt);
     }
 
     auto StatementVisitor::release_statement
-        () -> std::unique_ptr<Statement>
+        () -> Statement*
     {
-        return std::unique_ptr<Statement>(std::move(statement_));
+        return std::exchange(statement_, nullptr);
     }
 
     auto StatementVisitor::read_statement
-        (clang::Stmt* s) -> std::unique_ptr<Statement>
+        (clang::Stmt* s) -> Statement*
     {
-        this->TraverseStmt(s);
+        this->traverse(s);
         return this->release_statement();
     }
 
-    auto StatementVisitor::VisitCompoundStmt
-        (clang::CompoundStmt* compound) -> bool
+    auto StatementVisitor::read_compound
+        (clang::Stmt* s) -> std::optional<CompoundStatement>
     {
-        auto statements = std::vector<std::unique_ptr<Statement>>();
+        this->traverse(s);
+        return this->release_compound();
+    }
+
+    auto StatementVisitor::traverse
+        (clang::Stmt* const s) -> void
+    {
+        auto frames = std::vector<Frame>();
+        this->TraverseStmt(s);
+        for (;;)
+        {
+            if (pending_)
+            {
+                frames.push_back(Frame {std::exchange(pending_, nullptr)});
+            }
+
+            if (frames.empty())
+            {
+                break;
+            }
+
+            if (auto const part = this->resume(frames.back()))
+            {
+                this->TraverseStmt(*part);
+            }
+            else
+            {
+                frames.pop_back();
+            }
+        }
+    }
 
-        for (auto const s : compound->body())
+    auto StatementVisitor::resume
+        (Frame& f) -> std::optional<clang::Stmt*>
+    {
+        if (auto const compound = clang::dyn_cast<clang::CompoundStmt>(f.node_))
         {
-            this->TraverseStmt(s);
-            auto statement = this->release_statement();
-            statements.emplace_back(statement ? std::move(statement) : std::make_unique<ExpressionStatement>(std::make_unique<StringLiteral>("<unknown statement>")));
+            if (f.step_ > 0)
+            {
+                auto statement = this->release_statement();
+                f.statements_.emplace_back(statement ? std::move(statement) : arena_->make<ExpressionStatement>(arena_->make<StringLiteral>(arena_->intern("<unknown statement>"))));
+            }
+            if (f.step_ < compound->size())
+            {
+                return compound->body_begin()[f.step_++];
+            }
+            compound_.emplace(std::move(f.statements_));
         }
+        else if (auto const ifs = clang::dyn_cast<clang::IfStmt>(f.node_))
+        {
+            switch (f.step_++)
+            {
+                case 0:
+                    f.cond_ = expressioner_.read_expression(ifs->getCond());
+                    return ifs->getThen();
 
-        compound_ = std::make_unique<CompoundStatement>(std::move(statements));
+                case 1:
+                    f.then_ = this->release_body();
+                    if (ifs->getElse())
+                    {
+                        return ifs->getElse();
+                    }
+                    statement_ = arena_->make<If>(std::move(f.cond_), std::move(*f.then_));
+                    break;
+
+                default:
+                    statement_ = arena_->make<If>(std::move(f.cond_), std::move(*f.then_), this->release_body());
+                    break;
+            }
+        }
+        else if (auto const w = clang::dyn_cast<clang::WhileStmt>(f.node_))
+        {
+            if (f.step_++ == 0)
+            {
+                f.cond_ = expressioner_.read_expression(w->getCond());
+                return w->getBody();
+            }
+            statement_ = arena_->make<WhileLoop>(std::move(f.cond_), this->release_body());
+        }
+        else if (auto const d = clang::dyn_cast<clang::DoStmt>(f.node_))
+        {
+            if (f.step_++ == 0)
+            {
+                f.cond_ = expressioner_.read_expression(d->getCond());
+                return d->getBody();
+            }
+            statement_ = arena_->make<DoWhileLoop>(std::move(f.cond_), this->release_body());
+        }
+        else if (auto const fs = clang::dyn_cast<clang::ForStmt>(f.node_))
+        {
+            if (f.step_ == 0)
+            {
+                ++f.step_;
+                if (auto const varp = fs->getInit())
+                {
+                    return varp;
+                }
+            }
+            if (f.step_ == 1)
+            {
+                ++f.step_;
+                auto const condp = fs->getCond();
+                auto const incp  = fs->getInc();
+
+                f.init_ = not fs->getInit() ? nullptr : this->release_statement();
+                f.cond_ = not condp ? nullptr : expressioner_.read_expression(condp);
+                f.inc_  = not incp  ? nullptr : expressioner_.read_expression(incp);
+                return fs->getBody();
+            }
+            statement_ = arena_->make<ForLoop>(std::move(f.init_), std::move(f.cond_), std::move(f.inc_), this->release_body());
+        }
+        else if (auto const sw = clang::dyn_cast<clang::SwitchStmt>(f.node_))
+        {
+            return this->resume_switch(f, sw);
+        }
+        return std::nullopt;
+    }
+
+    auto StatementVisitor::resume_switch
+        (Frame& f, clang::SwitchStmt* const s) -> std::optional<clang::Stmt*>
+    {
+        auto const body     = clang::dyn_cast_or_null<clang::CompoundStmt>(s->getBody());
+        auto const size     = body ? std::size_t {body->size()} : 0;
+        auto const is_label = [](clang::Stmt* const c)
+        {
+            return clang::isa<clang::CaseStmt>(c) or clang::isa<clang::DefaultStmt>(c);
+        };
+        auto const close_group = [&f]()
+        {
+            if (f.group_ == SwitchGroup::Case)
+            {
+                f.cases_.emplace_back(std::move(f.case_), std::move(f.statements_));
+            }
+            else if (f.group_ == SwitchGroup::Default)
+            {
+                f.default_.emplace(std::move(f.statements_));
+            }
+            f.statements_.clear();
+            f.group_ = SwitchGroup::None;
+        };
+
+        // Step is one past the index of the next child of the body.
+        if (f.step_ == 0)
+        {
+            f.cond_ = expressioner_.read_expression(s->getCond());
+            f.step_ = 1;
+        }
+        else
+        {
+            switch (f.part_)
+            {
+                case SwitchPart::Label:
+                    f.statements_.emplace_back(this->release_statement());
+                    break;
+
+                case SwitchPart::Following:
+                    if (auto stmt = this->release_statement())
+                    {
+                        f.statements_.emplace_back(std::move(stmt));
+                    }
+                    break;
+
+                case SwitchPart::CaseBody:
+                    f.cases_.emplace_back(std::move(f.case_), std::move(*this->release_compound()));
+                    break;
+            }
+        }
+
+        while (f.step_ <= size)
+        {
+            auto const child = body->body_begin()[f.step_ - 1];
+            ++f.step_;
+
+            if (f.group_ != SwitchGroup::None and not is_label(child))
+            {
+                if (clang::isa<clang::BreakStmt>(child))
+                {
+                    continue;
+                }
+                f.part_ = SwitchPart::Following;
+                return child;
+            }
+
+            close_group();
+            if (auto const swCase = clang::dyn_cast<clang::CaseStmt>(child))
+            {
+                f.case_ = swCase->child_begin() != swCase->child_end()
+                    ? expressioner_.read_expression(*swCase->child_begin())
+                    : nullptr;
+
+                auto const subStmt = swCase->getSubStmt();
+                if (clang::isa_and_nonnull<clang::CompoundStmt>(subStmt))
+                {
+                    f.part_ = SwitchPart::CaseBody;
+                    return subStmt;
+                }
+                else if (subStmt)
+                {
+                    f.group_ = SwitchGroup::Case;
+                    f.part_  = SwitchPart::Label;
+                    return subStmt;
+                }
+                else // TODO empty case, subStmt might asctually be next case?
+                {
+                    f.cases_.emplace_back(std::move(f.case_), CompoundStatement(std::vector<Statement*>()));
+                    f.step_ = size + 1;
+                }
+            }
+            else if (auto const swDefault = clang::dyn_cast<clang::DefaultStmt>(child))
+            {
+                f.group_ = SwitchGroup::Default;
+                if (swDefault->getSubStmt())
+                {
+                    f.part_ = SwitchPart::Label;
+                    return swDefault->getSubStmt();
+                }
+            }
+            else
+            {
+                expressioner_.diagnostics().unexpected_in_switch(child);
+            }
+        }
+        close_group();
+
+        statement_ = f.default_
+            ? arena_->make<Switch>(std::move(f.cond_), std::move(f.cases_), std::move(*f.default_))
+            : arena_->make<Switch>(std::move(f.cond_), std::move(f.cases_));
+        return std::nullopt;
+    }
+
+    auto StatementVisitor::release_body
+        () -> CompoundStatement
+    {
+        auto cb = this->release_compound();
+        return cb ? CompoundStatement(std::move(*cb))
+                  : CompoundStatement(this->release_statement());
+    }
+
+    auto StatementVisitor::VisitCompoundStmt
+        (clang::CompoundStmt* compound) -> bool
+    {
+        pending_ = compound;
         return false;
     }
 
@@ -52,15 +327,15 @@ namespace fri
         auto const init = decl->getInit();
         if (init)
         {
-            statement_ = std::make_unique<VarDefinition>
+            statement_ = arena_->make<VarDefinition>
                 ( extract_type(context_->getPrintingPolicy(), decl->getType(), expressioner_)
-                , decl->getName().str(), expressioner_.read_expression(init) );
+                , arena_->intern(decl->getName()), expressioner_.read_expression(init) );
         }
         else
         {
-            statement_ = std::make_unique<VarDefinition>
+            statement_ = arena_->make<VarDefinition>
                 ( extract_type(context_->getPrintingPolicy(), decl->getType(), expressioner_)
-                , decl->getName().str() );
+                , arena_->intern(decl->getName()) );
         }
         return false;
     }
@@ -68,240 +343,91 @@ namespace fri
     auto StatementVisitor::VisitReturnStmt
         (clang::ReturnStmt* ret) -> bool
     {
-        statement_ = std::make_unique<Return>(expressioner_.read_expression(ret->getRetValue()));
+        statement_ = arena_->make<Return>(expressioner_.read_expression(ret->getRetValue()));
         return false;
     }
 
     auto StatementVisitor::VisitCompoundAssignOperator
         (clang::CompoundAssignOperator* ca) -> bool
     {
-        statement_ = std::make_unique<ExpressionStatement>(expressioner_.read_expression(ca));
+        statement_ = arena_->make<ExpressionStatement>(expressioner_.read_expression(ca));
         return false;
     }
 
     auto StatementVisitor::VisitIfStmt
         (clang::IfStmt* ifs) -> bool
     {
-        auto cond = expressioner_.read_expression(ifs->getCond());
-        this->TraverseStmt(ifs->getThen());
-        auto then = compound_ ? CompoundStatement(std::move(*this->release_compound()))
-                              : CompoundStatement(this->release_statement());
-        if (ifs->getElse())
-        {
-            this->TraverseStmt(ifs->getElse());
-            auto els = compound_ ? CompoundStatement(std::move(*this->release_compound()))
-                                 : CompoundStatement(this->release_statement());
-            statement_ = std::make_unique<If>(std::move(cond), std::move(then), std::move(els));
-        }
-        else
-        {
-            statement_ = std::make_unique<If>(std::move(cond), std::move(then));
-        }
+        pending_ = ifs;
         return false;
     }
 
     auto StatementVisitor::VisitWhileStmt
         (clang::WhileStmt* w) -> bool
     {
-        auto c = expressioner_.read_expression(w->getCond());
-        this->TraverseStmt(w->getBody());
-        auto cb = this->release_compound();
-        if (cb)
-        {
-            statement_ = std::make_unique<WhileLoop>(std::move(c), std::move(*cb));
-        }
-        else
-        {
-            auto b = this->release_statement();
-            statement_ = std::make_unique<WhileLoop>(std::move(c), CompoundStatement(std::move(b)));
-        }
+        pending_ = w;
         return false;
     }
 
     auto StatementVisitor::VisitDoStmt
         (clang::DoStmt* d) -> bool
     {
-        auto c = expressioner_.read_expression(d->getCond());
-        this->TraverseStmt(d->getBody());
-        auto cb = this->release_compound();
-        if (cb)
-        {
-            statement_ = std::make_unique<DoWhileLoop>(std::move(c), std::move(*cb));
-        }
-        else
-        {
-            auto b = this->release_statement();
-            statement_ = std::make_unique<DoWhileLoop>(std::move(c), CompoundStatement(std::move(b)));
-        }
+        pending_ = d;
         return false;
     }
 
     auto StatementVisitor::VisitForStmt
         (clang::ForStmt* f) -> bool
     {
-        auto const varp  = f->getInit();
-        auto const condp = f->getCond();
-        auto const incp  = f->getInc();
-
-        auto var   = not varp  ? std::unique_ptr<Statement>()  : this->read_statement(varp);
-        auto cond  = not condp ? std::unique_ptr<Expression>() : expressioner_.read_expression(condp);
-        auto inc   = not incp  ? std::unique_ptr<Expression>() : expressioner_.read_expression(incp);
-        auto body  = [this, f]()
-        {
-            this->TraverseStmt(f->getBody());
-            auto cb = this->release_compound();
-            return cb ? std::move(cb) : [this]()
-            {
-                auto b = this->release_statement();
-                return std::make_unique<CompoundStatement>(std::move(b));
-            }();
-        }();
-
-        statement_ = std::make_unique<ForLoop>(std::move(var), std::move(cond), std::move(inc), std::move(*body));
+        pending_ = f;
         return false;
     }
 
     auto StatementVisitor::VisitUnaryOperator
         (clang::UnaryOperator* uo) -> bool
     {
-        statement_ = std::make_unique<ExpressionStatement>(expressioner_.read_expression(uo));
+        statement_ = arena_->make<ExpressionStatement>(expressioner_.read_expression(uo));
         return false;
     }
 
     auto StatementVisitor::VisitCXXDeleteExpr
         (clang::CXXDeleteExpr* d) -> bool
     {
-        statement_ = std::make_unique<Delete>(expressioner_.read_expression(d->getArgument()));
+        statement_ = arena_->make<Delete>(expressioner_.read_expression(d->getArgument()));
         return false;
     }
 
     auto StatementVisitor::VisitCallExpr
         (clang::CallExpr* c) -> bool
     {
-        statement_ = std::make_unique<ExpressionStatement>(expressioner_.read_expression(c));
+        statement_ = arena_->make<ExpressionStatement>(expressioner_.read_expression(c));
         return false;
     }
 
     auto StatementVisitor::VisitBinaryOperator
         (clang::BinaryOperator* const op) -> bool
     {
-        statement_ = std::make_unique<ExpressionStatement>(expressioner_.read_expression(op));
+        statement_ = arena_->make<ExpressionStatement>(expressioner_.read_expression(op));
         return false;
     }
 
     auto StatementVisitor::VisitCXXThrowExpr
         (clang::CXXThrowExpr* const) -> bool
     {
-        statement_ = std::make_unique<Throw>();
+        statement_ = arena_->make<Throw>();
         return false;
     }
 
     auto StatementVisitor::VisitSwitchStmt
         (clang::SwitchStmt* const s) -> bool
     {
-        auto cond  = expressioner_.read_expression(s->getCond());
-        auto cases = std::vector<Case>();
-        auto def   = std::optional<CompoundStatement>{};
-
-        auto swCit = s->child_begin();
-        ++swCit; // cond
-        if (swCit != s->child_end() and clang::isa<clang::CompoundStmt>(*swCit))
-        {
-            auto const end = (*swCit)->child_end();
-            auto cit = (*swCit)->child_begin();
-            while (cit != end)
-            {
-                if (auto const swCase = clang::dyn_cast<clang::CaseStmt>(*cit))
-                {
-                    auto caseExpr = swCase->child_begin() != swCase->child_end()
-                        ? expressioner_.read_expression(*swCase->child_begin())
-                        : std::unique_ptr<Expression>();
-
-                    auto const subStmt = swCase->getSubStmt();
-                    if (auto const compoundSub = clang::dyn_cast<clang::CompoundStmt>(subStmt))
-                    {
-                        this->VisitCompoundStmt(compoundSub);
-                        cases.emplace_back(std::move(caseExpr), std::move(*this->release_compound()));
-                        ++cit;
-                    }
-                    else if (subStmt)
-                    {
-                        auto caseBody = std::vector<uptr<Statement>>();
-                        caseBody.emplace_back(this->read_statement(subStmt));
-                        ++cit;
-
-                        while (cit != end and not (clang::isa<clang::CaseStmt>(*cit) or clang::isa<clang::DefaultStmt>(*cit)))
-                        {
-                            if (not clang::isa<clang::BreakStmt>(*cit))
-                            {
-                                auto stmt = this->read_statement(*cit);
-                                if (stmt)
-                                {
-                                    caseBody.emplace_back(std::move(stmt));
-                                }
-                            }
-                            ++cit;
-                        }
-                        cases.emplace_back(std::move(caseExpr), std::move(caseBody));
-                    }
-                    else // TODO empty case, subStmt might asctually be next case?
-                    {
-                        cases.emplace_back(std::move(caseExpr), CompoundStatement(std::vector<uptr<Statement>>()));
-                        while (cit != end)
-                        {
-                            ++cit;
-                        }
-                    }
-                }
-                else if (auto const swDefault = clang::dyn_cast<clang::DefaultStmt>(*cit))
-                {
-                    auto defaultBody = std::vector<uptr<Statement>>();
-                    if (swDefault->getSubStmt())
-                    {
-                        defaultBody.emplace_back(this->read_statement(swDefault->getSubStmt()));
-                    }
-                    ++cit; // subStmt
-                    while (cit != end and not (clang::isa<clang::CaseStmt>(*cit) or clang::isa<clang::DefaultStmt>(*cit)))
-                    {
-                        if (not clang::isa<clang::BreakStmt>(*cit))
-                        {
-                            auto stmt = this->read_statement(*cit);
-                            if (stmt)
-                            {
-                                defaultBody.emplace_back(std::move(stmt));
-                            }
-                        }
-                        ++cit;
-                    }
-                    def = std::optional<CompoundStatement>(std::move(defaultBody));
-                }
-                else
-                {
-                    std::cout << "## Unexpected statement in switch." << '\n';
-                    (*cit)->dump();
-                    ++cit;
-                }
-            }
-        }
-
-        statement_ = def
-            ? std::make_unique<Switch>(std::move(cond), std::move(cases), std::move(*def))
-            : std::make_unique<Switch>(std::move(cond), std::move(cases));
-
-        // std::cout << "## Cond:" << '\n';
-        // s->getCond();
-        // for (auto const c : (*(++s->child_begin()))->children())
-        // {
-        //     std::cout << "## Child:" << '\n';
-        //     c->dump();
-        // }
+        pending_ = s;
         return false;
     }
 
     auto StatementVisitor::VisitBreakStmt
         (clang::BreakStmt* const) -> bool
     {
-        statement_ = std::make_unique<Break>();
+        statement_ = arena_->make<Break>();
         return false;
     }
 }
\ No newline at end of file
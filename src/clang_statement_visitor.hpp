@@ -5,17 +5,19 @@
 #include "abstract_code.hpp"
 #include "clang_expression_visitor.hpp"
 #include <memory>
+#include <optional>
 
 namespace fri
 {
     class StatementVisitor : public clang::RecursiveASTVisitor<StatementVisitor>
     {
     public:
-        StatementVisitor (clang::ASTContext&);
+        StatementVisitor (clang::ASTContext&, Arena&, TypePool&, DiagnosticSink&);
 
-        auto release_statement ()             -> std::unique_ptr<Statement>;
-        auto release_compound  ()             -> std::unique_ptr<CompoundStatement>;
-        auto read_statement    (clang::Stmt*) -> std::unique_ptr<Statement>;
+        auto release_statement ()             -> Statement*;
+        auto release_compound  ()             -> std::optional<CompoundStatement>;
+        auto read_statement    (clang::Stmt*) -> Statement*;
+        auto read_compound     (clang::Stmt*) -> std::optional<CompoundStatement>;
 
         auto VisitCompoundStmt           (clang::CompoundStmt*)           -> bool;
         auto VisitVarDecl                (clang::VarDecl*)                -> bool;
@@ -34,10 +36,37 @@ namespace fri
         auto VisitBreakStmt              (clang::BreakStmt*)              -> bool;
 
     private:
-        clang::ASTContext*                 context_;
-        std::unique_ptr<Statement>         statement_ {};
-        std::unique_ptr<CompoundStatement> compound_  {};
-        ExpressionVisitor                  expressioner_;
+        struct Frame;
+
+        /**
+         *  @brief Traverses @p s and reads nested statements recorded by visits
+         *  of compounds, conditions, loops and switches using an explicit stack
+         *  of frames, so that deep nesting does not exhaust the call stack.
+         */
+        auto traverse (clang::Stmt*) -> void;
+
+        /**
+         *  @brief Advances reading of a nested statement.
+         *  @return next part of the statement to traverse
+         *  or nullopt if the statement is finished.
+         */
+        auto resume (Frame&) -> std::optional<clang::Stmt*>;
+
+        /**
+         *  @brief Advances reading of switch @p s , whose statements
+         *  are grouped by the labels that precede them.
+         */
+        auto resume_switch (Frame&, clang::SwitchStmt*) -> std::optional<clang::Stmt*>;
+
+        auto release_body () -> CompoundStatement;
+
+    private:
+        clang::ASTContext*               context_;
+        Arena*                           arena_;
+        clang::Stmt*                     pending_   {nullptr};
+        Statement*                       statement_ {nullptr};
+        std::optional<CompoundStatement> compound_  {};
+        ExpressionVisitor                expressioner_;
     };
 }
 
@@ -8,35 +8,36 @@ namespace fri
     auto extract_type ( clang::PrintingPolicy const& pp
                       , clang::Type const*           typePtr
                       , ExpressionVisitor&           ex
-                      , IsConst                      isConst ) -> uptr<Type>
+                      , IsConst                      isConst ) -> Type*
     {
+        auto& arena = ex.arena();
+        auto& types = ex.types();
         if (auto const ptr = clang::dyn_cast<clang::PointerType>(typePtr))
         {
-            return std::make_unique<Indirection>(isConst, extract_type(pp, ptr->getPointeeType(), ex));
+            return types.indirection(isConst, extract_type(pp, ptr->getPointeeType(), ex));
         }
         else if (auto const ref = clang::dyn_cast<clang::ReferenceType>(typePtr))
         {
-            return std::make_unique<Indirection>(isConst, extract_type(pp, ref->getPointeeType(), ex));
+            return types.indirection(isConst, extract_type(pp, ref->getPointeeType(), ex));
         }
         else if (auto const builtin = clang::dyn_cast<clang::BuiltinType>(typePtr))
         {
-            return std::make_unique<PrimType>(isConst, builtin->getName(pp).str());
+            return types.prim_type(isConst, arena.intern(builtin->getName(pp)));
         }
         else if (auto const typedefed = clang::dyn_cast<clang::TypedefType>(typePtr))
         {
-            using uptr = uptr<Type>;
             return clang::isa<clang::BuiltinType>(typedefed->desugar().getTypePtr())
-                ? uptr(std::make_unique<PrimType>(isConst, typedefed->getDecl()->getName().str()))
-                : std::make_unique<CustomType>(isConst, typedefed->getDecl()->getName().str());
+                ? types.prim_type(isConst, arena.intern(typedefed->getDecl()->getName()))
+                : types.custom_type(isConst, arena.intern(typedefed->getDecl()->getName()));
         }
         else if (auto const record = clang::dyn_cast<clang::RecordType>(typePtr))
         {
-            return std::make_unique<CustomType>(isConst, record->getAsRecordDecl()->getName().str());
+            return types.custom_type(isConst, arena.intern(record->getAsRecordDecl()->getName()));
         }
         else if (auto temParam = clang::dyn_cast<clang::TemplateTypeParmType>(typePtr))
         {
             auto paramDecl = temParam->getDecl();
-            return std::make_unique<CustomType>(isConst, paramDecl->getIdentifier()->getName().str());
+            return types.custom_type(isConst, arena.intern(paramDecl->getIdentifier()->getName()));
         }
         else if (auto tem = clang::dyn_cast<clang::TemplateSpecializationType>(typePtr))
         {
@@ -64,20 +65,20 @@ namespace fri
 
                     case clang::TemplateArgument::ArgKind::Integral:
                     {
-                        args.emplace_back(variant_t(std::make_unique<PrimType>(IsConst(false), "<dummy integral>")));
+                        args.emplace_back(variant_t(types.prim_type(IsConst(false), arena.intern("<dummy integral>"))));
                         break;
                     }
 
                     default:
                     {
-                        args.emplace_back(variant_t(std::make_unique<PrimType>(IsConst(false), "<dummy other>")));
+                        args.emplace_back(variant_t(types.prim_type(IsConst(false), arena.intern("<dummy other>"))));
                         break;
                     }
                 }
             }
-            return std::make_unique<TemplatedType>( isConst
-                                                  , std::make_unique<CustomType>(IsConst(false), name)
-                                                  , std::move(args) );
+            return types.templated_type( isConst
+                                       , types.custom_type(IsConst(false), arena.intern(name))
+                                       , std::move(args) );
         }
         else if (auto elab = clang::dyn_cast<clang::ElaboratedType>(typePtr))
         {
@@ -86,13 +87,13 @@ namespace fri
         }
         else if (auto func = clang::dyn_cast<clang::FunctionProtoType>(typePtr))
         {
-            auto params = std::vector<uptr<Type>>();
+            auto params = std::vector<Type*>();
             for (auto const paramType : func->getParamTypes())
             {
                 params.emplace_back(extract_type(pp, paramType, ex));
             }
-            return std::make_unique<Function>( std::move(params)
-                                            , extract_type(pp, func->getReturnType(), ex) );
+            auto ret = extract_type(pp, func->getReturnType(), ex);
+            return types.function(std::move(params), ret);
         }
         else if (auto const icn = clang::dyn_cast<clang::InjectedClassNameType>(typePtr))
         {
@@ -101,39 +102,54 @@ namespace fri
         else if (auto const dnt = clang::dyn_cast<clang::DependentNameType>(typePtr))
         {
             auto nestSpec = dnt->getQualifier();
-            auto name = dnt->getIdentifier()->getName().str();
+            auto name = arena.intern(dnt->getIdentifier()->getName());
             switch (nestSpec->getKind())
             {
                 case clang::NestedNameSpecifier::SpecifierKind::TypeSpec:
                 {
                     auto nest = extract_type(pp, nestSpec->getAsType(), ex, IsConst(false));
-                    return std::make_unique<Nested>(isConst, std::move(nest), std::move(name));
+                    return types.nested(isConst, nest, name);
                 }
 
                 default:
                 {
-                        std::cout << "## Unknown type:" << '\n';
-                        typePtr->dump();
-                    return std::make_unique<PrimType>(IsConst(false), "<unknown nested type>");
+                    ex.diagnostics().unknown_type(typePtr);
+                    return types.prim_type(IsConst(false), arena.intern("<unknown nested type>"));
                 }
             }
         }
         else
         {
-                std::cout << "## Unknown type:" << '\n';
-                typePtr->dump();
-            // return std::make_unique<PrimType>(IsConst(false), std::string("<unknown type> (") + qt.getAsString() + std::string(")"));
-            return std::make_unique<PrimType>(IsConst(false), std::string("<unknown type>"));
+            ex.diagnostics().unknown_type(typePtr);
+            // return arena.make<PrimType>(IsConst(false), std::string("<unknown type> (") + qt.getAsString() + std::string(")"));
+            return types.prim_type(IsConst(false), arena.intern("<unknown type>"));
         }
     }
 
     auto extract_type ( clang::PrintingPolicy const& pp
                       , clang::QualType              qt
-                      , ExpressionVisitor&           ex ) -> uptr<Type>
+                      , ExpressionVisitor&           ex ) -> Type*
     {
-        auto const isConst = qt.isConstQualified();
+        auto const isConst = IsConst(qt.isConstQualified());
         auto const typePtr = qt.getTypePtr();
-        return extract_type(pp, typePtr, ex, IsConst(isConst));
+
+        // Sugared types are unique within the context as well,
+        // canonical types would lose names of typedefs.
+        auto& types = ex.types();
+        if (auto const type = types.find(typePtr, isConst))
+        {
+            return type;
+        }
+
+        // Types with unknown parts are extracted again, so that
+        // each of their occurrences is reported.
+        auto const recorded = ex.diagnostics().recorded();
+        auto const type     = extract_type(pp, typePtr, ex, isConst);
+        if (ex.diagnostics().recorded() == recorded)
+        {
+            types.remember(typePtr, isConst, type);
+        }
+        return type;
     }
 
     auto switch_bin_operator (clang::BinaryOperatorKind const op) -> BinOpcode
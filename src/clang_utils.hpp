@@ -19,7 +19,7 @@ namespace fri
 
     auto extract_type        ( clang::PrintingPolicy const&
                              , clang::QualType
-                             , ExpressionVisitor& ) -> uptr<Type>;
+                             , ExpressionVisitor& ) -> Type*;
     auto switch_bin_operator (clang::BinaryOperatorKind) -> BinOpcode;
     auto switch_un_operator  (clang::UnaryOperatorKind)  -> UnOpcode;
 }
@@ -0,0 +1,47 @@
+#include "class_registry.hpp"
+
+namespace fri
+{
+    ClassRegistry::ClassRegistry
+        (std::vector<Class*>& classes, Arena& arena) :
+        classes_ (&classes),
+        arena_   (&arena)
+    {
+        for (auto i = std::size_t {0}; i < classes_->size(); ++i)
+        {
+            this->add_index(i);
+        }
+    }
+
+    auto ClassRegistry::get
+        (std::string const& qualName) -> Class&
+    {
+        auto const it = qualNames_.find(qualName);
+        if (it != std::end(qualNames_))
+        {
+            return *(*classes_)[it->second];
+        }
+
+        classes_->emplace_back(arena_->make<Class>(qualName));
+        this->add_index(classes_->size() - 1);
+        return *classes_->back();
+    }
+
+    auto ClassRegistry::find_by_name
+        (std::string const& name) const -> Class*
+    {
+        auto const it = names_.find(name);
+        return it != std::end(names_) ? (*classes_)[it->second] : nullptr;
+    }
+
+    auto ClassRegistry::add_index
+        (std::size_t const index) -> void
+    {
+        auto const& qualName = (*classes_)[index]->qualName_;
+        auto const  nameEnd  = qualName.rfind("::");
+        auto const  name     = nameEnd == std::string::npos ? qualName : qualName.substr(nameEnd + 2);
+        qualNames_.try_emplace(qualName, index);
+        // First class with the name wins, as if searched in order.
+        names_.try_emplace(name, index);
+    }
+}
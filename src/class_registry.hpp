@@ -0,0 +1,44 @@
+#ifndef FRI_CLASS_REGISTRY_HPP
+#define FRI_CLASS_REGISTRY_HPP
+
+#include "abstract_code.hpp"
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace fri
+{
+    /**
+     *  @brief Classes of a translation unit in the order in which they were
+     *  first found. Indexed by qualified name and by unqualified name.
+     */
+    class ClassRegistry
+    {
+    public:
+        ClassRegistry (std::vector<Class*>& classes, Arena& arena);
+
+        /**
+         *  @brief Finds class with qualified name @p qualName or adds
+         *  a new one created in the arena.
+         */
+        auto get (std::string const& qualName) -> Class&;
+
+        /**
+         *  @brief Finds the first class with unqualified name @p name .
+         */
+        auto find_by_name (std::string const& name) const -> Class*;
+
+    private:
+        auto add_index (std::size_t index) -> void;
+
+    private:
+        std::vector<Class*>*                         classes_;
+        Arena*                                       arena_;
+        std::unordered_map<std::string, std::size_t> qualNames_;
+        std::unordered_map<std::string, std::size_t> names_;
+    };
+}
+
+#endif
@@ -82,11 +82,16 @@ namespace fri
                            , .current = indentCurrent_ };
     }
 
+    auto CommonCodePrinter::indent_width
+        (IndentState const s) -> std::size_t
+    {
+        return std::min(Spaces.size(), s.current * s.step);
+    }
+
     auto CommonCodePrinter::get_indent
         () const -> std::string_view
     {
-        auto const sc = std::min(Spaces.size(), indentCurrent_ * indentStep_);
-        return Spaces.substr(0, sc);
+        return Spaces.substr(0, indent_width(this->current_indent()));
     }
 
 // ConsoleCodePrinter definitions:
@@ -176,16 +181,16 @@ namespace fri
 // RtfCodePrinter definitions:
 
     RtfCodePrinter::RtfCodePrinter
-        (std::ofstream& ofst, OutputSettings const& settings) :
-        base  (settings),
-        ofst_ (&ofst)
+        (std::ostream& ost, OutputSettings const& settings) :
+        base (settings),
+        ost_ (&ost)
     {
-        *ofst_ << R"({\rtf1\ansi\deff0\f0\fs)"   << (2 * settings.fontSize) << '\n'
-               << R"({\fonttbl)"                 << '\n'
-               << R"({\f0\fmodern )"             << settings.font << ";}"   << '\n'
-               << R"(})"                         << '\n'
-               << R"({\colortbl)"                << '\n'
-               << R"(;)"                         << '\n';
+        *ost_ << R"({\rtf1\ansi\deff0\f0\fs)"   << (2 * settings.fontSize) << '\n'
+              << R"({\fonttbl)"                 << '\n'
+              << R"({\f0\fmodern )"             << settings.font << ";}"   << '\n'
+              << R"(})"                         << '\n'
+              << R"({\colortbl)"                << '\n'
+              << R"(;)"                         << '\n';
 
         for_each_color(settings.style, [this](auto const& c)
         {
@@ -197,30 +202,30 @@ namespace fri
             auto const ri = static_cast<unsigned>(r);
             auto const gi = static_cast<unsigned>(g);
             auto const bi = static_cast<unsigned>(b);
-            *ofst_ << R"(\red)"   << ri
-                   << R"(\green)" << gi
-                   << R"(\blue)"  << bi << ';' << '\n';
+            *ost_ << R"(\red)"   << ri
+                  << R"(\green)" << gi
+                  << R"(\blue)"  << bi << ';' << '\n';
         }
-        *ofst_ << R"(})" << '\n';
+        *ost_ << R"(})" << '\n';
     }
 
     RtfCodePrinter::~RtfCodePrinter
         ()
     {
-        ofst_->flush();
-        *ofst_ << "}";
+        ost_->flush();
+        *ost_ << "}";
     }
 
     auto RtfCodePrinter::begin_line
         () -> void
     {
-        *ofst_ << base::get_indent();
+        *ost_ << base::get_indent();
     }
 
     auto RtfCodePrinter::end_line
         () -> void
     {
-        *ofst_ << R"(\line)" << '\n';
+        *ost_ << R"(\line)" << '\n';
     }
 
     auto RtfCodePrinter::blank_line
@@ -238,7 +243,7 @@ namespace fri
     auto RtfCodePrinter::out
         (std::string_view s) -> RtfCodePrinter&
     {
-        *ofst_ << encode(s);
+        *ost_ << encode(s);
         return *this;
     }
 
@@ -256,15 +261,15 @@ namespace fri
     auto RtfCodePrinter::begin_color
         (Color const& c) -> void
     {
-        *ofst_ << R"({\cf)"
-               << this->color_code(c)
-               << ' ';
+        *ost_ << R"({\cf)"
+              << this->color_code(c)
+              << ' ';
     }
 
     auto RtfCodePrinter::end_color
         () -> void
     {
-        *ofst_ << '}';
+        *ost_ << '}';
     }
 
     auto RtfCodePrinter::begin_style
@@ -273,11 +278,11 @@ namespace fri
         switch (s)
         {
             case FontStyle::Bold:
-                *ofst_ << R"(\b )";
+                *ost_ << R"(\b )";
                 break;
 
             case FontStyle::Italic:
-                *ofst_ << R"(\i )";
+                *ost_ << R"(\i )";
                 break;
 
             default:
@@ -291,11 +296,11 @@ namespace fri
         switch (s)
         {
             case FontStyle::Bold:
-                *ofst_ << R"(\b0)";
+                *ost_ << R"(\b0)";
                 break;
 
             case FontStyle::Italic:
-                *ofst_ << R"(\i0)";
+                *ost_ << R"(\i0)";
                 break;
 
             default:
@@ -348,56 +353,50 @@ namespace fri
         return cs;
     }
 
-// DummyCodePrinter definitions:
+// PlainCodePrinter definitions:
 
-    DummyCodePrinter::DummyCodePrinter
-        (IndentState s) :
-        base (s)
+    PlainCodePrinter::PlainCodePrinter
+        (std::ostream& ost, OutputSettings const& settings) :
+        base (settings),
+        ost_ (&ost)
     {
     }
 
-    auto DummyCodePrinter::begin_line
+    auto PlainCodePrinter::begin_line
         () -> void
     {
-        currentColumn_ += base::get_indent().size();
+        *ost_ << base::get_indent();
     }
 
-    auto DummyCodePrinter::end_line
+    auto PlainCodePrinter::end_line
         () -> void
     {
-        currentColumn_ = 0;
+        *ost_ << '\n';
     }
 
-    auto DummyCodePrinter::blank_line
+    auto PlainCodePrinter::blank_line
         () -> void
     {
         this->end_line();
     }
 
-    auto DummyCodePrinter::end_region
+    auto PlainCodePrinter::end_region
         () -> void
     {
         this->blank_line();
     }
 
-    auto DummyCodePrinter::out
-        (std::string_view const s) -> DummyCodePrinter&
-    {
-        currentColumn_ += s.size();
-        return *this;
-    }
-
-    auto DummyCodePrinter::out
-        (std::string_view const s, TextStyle const&) -> DummyCodePrinter&
+    auto PlainCodePrinter::out
+        (std::string_view const s) -> PlainCodePrinter&
     {
-        this->out(s);
+        *ost_ << s;
         return *this;
     }
 
-    auto DummyCodePrinter::get_column
-        () const -> std::size_t
+    auto PlainCodePrinter::out
+        (std::string_view const s, TextStyle const&) -> PlainCodePrinter&
     {
-        return currentColumn_;
+        return this->out(s);
     }
 
 // NumberedCodePrinter definitions:
@@ -500,23 +499,344 @@ namespace fri
         decoree_->out(Spaces.substr(0, std::min(numWidth_ + 2, Spaces.size())));
     }
 
+// LayoutCodePrinter definitions:
+
+    LayoutCodePrinter::LayoutCodePrinter
+        (ICodePrinter& d) :
+        decoree_ {&d}
+    {
+    }
+
+    auto LayoutCodePrinter::inc_indent
+        () -> void
+    {
+        this->keep(Op::IncIndent);
+    }
+
+    auto LayoutCodePrinter::dec_indent
+        () -> void
+    {
+        this->keep(Op::DecIndent);
+    }
+
+    auto LayoutCodePrinter::begin_line
+        () -> void
+    {
+        this->keep(Op::BeginLine);
+    }
+
+    auto LayoutCodePrinter::end_line
+        () -> void
+    {
+        this->keep(Op::EndLine);
+    }
+
+    auto LayoutCodePrinter::wrap_line
+        () -> void
+    {
+        this->keep(Op::WrapLine);
+    }
+
+    auto LayoutCodePrinter::blank_line
+        () -> void
+    {
+        this->keep(Op::BlankLine);
+    }
+
+    auto LayoutCodePrinter::end_region
+        () -> void
+    {
+        this->keep(Op::EndRegion);
+    }
+
+    auto LayoutCodePrinter::out
+        (std::string_view const s) -> LayoutCodePrinter&
+    {
+        this->keep(Op::Out, s);
+        return *this;
+    }
+
+    auto LayoutCodePrinter::out
+        (std::string_view const s, TextStyle const& st) -> LayoutCodePrinter&
+    {
+        this->keep(Op::OutStyled, s, st);
+        return *this;
+    }
+
+    auto LayoutCodePrinter::current_indent
+        () const -> IndentState
+    {
+        return decoree_->current_indent();
+    }
+
+    auto LayoutCodePrinter::begin_group
+        (std::size_t const width) -> void
+    {
+        open_.push_back(tokens_.size());
+        tokens_.push_back(Token {.op_ = Op::BeginGroup, .size_ = width});
+    }
+
+    auto LayoutCodePrinter::end_group
+        () -> void
+    {
+        assert(not open_.empty());
+        tokens_[open_.back()].end_ = tokens_.size();
+        tokens_.push_back(Token {.op_ = Op::EndGroup});
+        open_.pop_back();
+        if (open_.empty())
+        {
+            this->flush();
+        }
+    }
+
+    auto LayoutCodePrinter::soft_line
+        (std::string_view const flat) -> void
+    {
+        this->keep(Op::SoftLine, flat);
+    }
+
+    auto LayoutCodePrinter::soft_inc_indent
+        () -> void
+    {
+        this->keep(Op::SoftIncIndent);
+    }
+
+    auto LayoutCodePrinter::soft_dec_indent
+        () -> void
+    {
+        this->keep(Op::SoftDecIndent);
+    }
+
+    auto LayoutCodePrinter::keep
+        (Op const op, std::string_view const s, TextStyle const& st) -> void
+    {
+        if (open_.empty())
+        {
+            // Soft output outside of groups is always flat.
+            switch (op)
+            {
+                case Op::Out:       decoree_->out(s);     break;
+                case Op::OutStyled: decoree_->out(s, st); break;
+                case Op::IncIndent: decoree_->inc_indent(); break;
+                case Op::DecIndent: decoree_->dec_indent(); break;
+                case Op::BeginLine: decoree_->begin_line(); break;
+                case Op::EndLine:   decoree_->end_line();   break;
+                case Op::WrapLine:  decoree_->wrap_line();  break;
+                case Op::BlankLine: decoree_->blank_line(); break;
+                case Op::EndRegion: decoree_->end_region(); break;
+                case Op::SoftLine:  decoree_->out(s);     break;
+                default:                                  break;
+            }
+            return;
+        }
+
+        tokens_.push_back(Token {.op_ = op, .style_ = st, .first_ = chars_.size(), .size_ = s.size()});
+        chars_.append(s);
+    }
+
+    auto LayoutCodePrinter::text
+        (Token const& t) const -> std::string_view
+    {
+        return std::string_view(chars_).substr(t.first_, t.size_);
+    }
+
+    auto LayoutCodePrinter::layout
+        (std::size_t const group, std::size_t const level) -> Effect
+    {
+        auto const key = std::make_pair(group, level);
+        auto const it  = layouts_.find(key);
+        if (it != std::end(layouts_))
+        {
+            return it->second;
+        }
+
+        auto effect = this->measure(group, level, false);
+        if (effect.columns_ > tokens_[group].size_)
+        {
+            effect = this->measure(group, level, true);
+        }
+        layouts_.emplace(key, effect);
+        return effect;
+    }
+
+    auto LayoutCodePrinter::measure
+        (std::size_t const group, std::size_t const level, bool const wrapped) -> Effect
+    {
+        auto const step = decoree_->current_indent().step;
+        auto e = Effect {wrapped, false, 0, level};
+
+        auto const inc = [&e]()
+        {
+            ++e.level_;
+        };
+        auto const dec = [&e]()
+        {
+            e.level_ = e.level_ > 0 ? e.level_ - 1 : 0;
+        };
+        auto const new_line = [&e]()
+        {
+            e.newLine_ = true;
+            e.columns_ = 0;
+        };
+        auto const begin_line = [&e, step]()
+        {
+            e.columns_ += CommonCodePrinter::indent_width(IndentState {.step = step, .current = e.level_});
+        };
+
+        // Nested groups are laid out on their own and skipped.
+        for (auto i = group + 1; i < tokens_[group].end_; ++i)
+        {
+            auto const& t = tokens_[i];
+            switch (t.op_)
+            {
+                case Op::Out:
+                case Op::OutStyled:
+                    e.columns_ += t.size_;
+                    break;
+
+                case Op::IncIndent: inc(); break;
+                case Op::DecIndent: dec(); break;
+                case Op::BeginLine: begin_line(); break;
+
+                case Op::EndLine:
+                case Op::BlankLine:
+                case Op::EndRegion:
+                    new_line();
+                    break;
+
+                case Op::WrapLine:
+                    new_line();
+                    begin_line();
+                    break;
+
+                case Op::SoftLine:
+                    if (wrapped)
+                    {
+                        new_line();
+                        begin_line();
+                    }
+                    else
+                    {
+                        e.columns_ += t.size_;
+                    }
+                    break;
+
+                case Op::SoftIncIndent:
+                    if (wrapped)
+                    {
+                        inc();
+                    }
+                    break;
+
+                case Op::SoftDecIndent:
+                    if (wrapped)
+                    {
+                        dec();
+                    }
+                    break;
+
+                case Op::BeginGroup:
+                {
+                    auto const nested = this->layout(i, e.level_);
+                    e.columns_ = nested.newLine_ ? nested.columns_ : e.columns_ + nested.columns_;
+                    e.newLine_ = e.newLine_ or nested.newLine_;
+                    e.level_   = nested.level_;
+                    i          = t.end_;
+                    break;
+                }
+
+                case Op::EndGroup:
+                    break;
+            }
+        }
+        return e;
+    }
+
+    auto LayoutCodePrinter::flush
+        () -> void
+    {
+        auto wrapped = std::vector<bool>();
+        for (auto i = std::size_t {0}; i < tokens_.size(); ++i)
+        {
+            auto const& t = tokens_[i];
+            switch (t.op_)
+            {
+                case Op::Out:       decoree_->out(this->text(t));           break;
+                case Op::OutStyled: decoree_->out(this->text(t), t.style_); break;
+                case Op::IncIndent: decoree_->inc_indent(); break;
+                case Op::DecIndent: decoree_->dec_indent(); break;
+                case Op::BeginLine: decoree_->begin_line(); break;
+                case Op::EndLine:   decoree_->end_line();   break;
+                case Op::WrapLine:  decoree_->wrap_line();  break;
+                case Op::BlankLine: decoree_->blank_line(); break;
+                case Op::EndRegion: decoree_->end_region(); break;
+
+                case Op::BeginGroup:
+                    wrapped.push_back(this->layout(i, decoree_->current_indent().current).wrapped_);
+                    break;
+
+                case Op::EndGroup:
+                    wrapped.pop_back();
+                    break;
+
+                case Op::SoftLine:
+                    if (wrapped.back())
+                    {
+                        decoree_->wrap_line();
+                    }
+                    else if (t.size_ > 0)
+                    {
+                        decoree_->out(this->text(t));
+                    }
+                    break;
+
+                case Op::SoftIncIndent:
+                    if (wrapped.back())
+                    {
+                        decoree_->inc_indent();
+                    }
+                    break;
+
+                case Op::SoftDecIndent:
+                    if (wrapped.back())
+                    {
+                        decoree_->dec_indent();
+                    }
+                    break;
+            }
+        }
+
+        tokens_.clear();
+        chars_.clear();
+        layouts_.clear();
+    }
+
 // PseudocodeGenerator definitions:
 
     PseudocodeGenerator::PseudocodeGenerator
-        (ICodePrinter& out, CodeStyleInfo style) :
+        (LayoutCodePrinter& out, CodeStyleInfo style, bool const outline, std::size_t const lineWidth) :
         out_       (&out),
         style_     (std::move(style)),
-        funcNames_ { {"free", "vráťPamäť"}
-                   , {"swap", "vymeň"}
-                   , {"memmove", "presuňPamäť"}
-                   , {"memcpy", "skopírujPamäť"}
-                   , {"memcmp", "porovnajPamäť"}
-                   , {"calloc", "alokujPamäť"}
-                   , {"malloc", "alokujPamäť"}
-                   , {"realloc", "zmeňVeľkosťPamäte"} }
+        outline_   (outline),
+        lineWidth_ (lineWidth)
     {
     }
 
+    auto PseudocodeGenerator::func_names
+        () -> std::unordered_map<std::string_view, std::string_view> const&
+    {
+        static auto const names = std::unordered_map<std::string_view, std::string_view>
+            { {"free", "vráťPamäť"}
+            , {"swap", "vymeň"}
+            , {"memmove", "presuňPamäť"}
+            , {"memcpy", "skopírujPamäť"}
+            , {"memcmp", "porovnajPamäť"}
+            , {"calloc", "alokujPamäť"}
+            , {"malloc", "alokujPamäť"}
+            , {"realloc", "zmeňVeľkosťPamäte"} };
+        return names;
+    }
+
     auto PseudocodeGenerator::visit
         (IntLiteral const& i) -> void
     {
@@ -571,6 +891,16 @@ namespace fri
         }
     }
 
+    auto PseudocodeGenerator::visit
+        (OperatorChain const& c) -> void
+    {
+        auto const opstr = bin_op_to_string(c.op_);
+        this->visit_range(c.operands_, [this, &opstr]()
+        {
+            out_->out(" ").out(opstr).out(" ");
+        });
+    }
+
     auto PseudocodeGenerator::visit
         (Parenthesis const& p) -> void
     {
@@ -707,7 +1037,7 @@ namespace fri
                 });
         };
 
-        if (t.to_string().starts_with("function"))
+        if (t.isStdFunction_)
         {
             out_args();
         }
@@ -723,7 +1053,7 @@ namespace fri
     auto PseudocodeGenerator::visit
         (Indirection const& p) -> void
     {
-        if (p.pointee_->to_string() == "void")
+        if (p.pointee_->isVoid_)
         {
             out_->out("adresa", style_.primType_);
         }
@@ -744,7 +1074,7 @@ namespace fri
             out_->out(", ");
         });
         out_->out(")");
-        if (f.ret_->to_string() != "void")
+        if (not f.ret_->isVoid_)
         {
             out_->out(" → ");
             f.ret_->accept(*this);
@@ -911,6 +1241,11 @@ namespace fri
         out_->end_line();
         out_->end_region();
 
+        if (outline_)
+        {
+            return;
+        }
+
         // Visit constructor definitions.
         for (auto const& constr : c.constructors_)
         {
@@ -942,27 +1277,66 @@ namespace fri
     auto PseudocodeGenerator::visit
         (ForLoop const& f) -> void
     {
-        auto forVar  = ForVarDefVisitor(*this);
-        auto forFrom = ForFromVisitor(*this);
-        auto forTo   = ForToVisitor(*this);
+        // Loops that step a variable towards a bound are shown as a range,
+        // others as the loop with a condition they are equivalent to.
+        auto const& shape = f.shape_;
+        if (not shape.counter_ or not shape.from_ or not shape.to_ or shape.step_ == 0)
+        {
+            this->out_cond_loop(f);
+            return;
+        }
 
         out_->out("Opakuj pre premennú ", style_.controlKeyword_);
-        if (f.var_)
+        this->out_var_name(shape.counter_->name_);
+        this->out_plain(": ");
+        shape.counter_->type_->accept(*this);
+
+        out_->out(" od ", style_.controlKeyword_);
+        shape.from_->accept(*this);
+        out_->out(" do ", style_.controlKeyword_);
+        shape.to_->accept(*this);
+        if (not shape.toIncl_)
         {
-            f.var_->accept(forVar);
+            this->out_plain(shape.step_ > 0 ? " - " : " + ");
+            this->visit(IntLiteral(1));
         }
+        f.body_.accept(*this);
+    }
 
-        out_->out(" od ", style_.controlKeyword_);
+    auto PseudocodeGenerator::out_cond_loop
+        (ForLoop const& f) -> void
+    {
         if (f.var_)
         {
-            f.var_->accept(forFrom);
+            f.var_->accept(*this);
+            out_->end_line();
+            out_->begin_line();
         }
-        out_->out(" do ", style_.controlKeyword_);
+
+        out_->out("Pokiaľ ", style_.controlKeyword_);
+        out_->out("(");
         if (f.cond_)
         {
-            f.cond_->accept(forTo);
+            f.cond_->accept(*this);
         }
-        f.body_.accept(*this);
+        else
+        {
+            this->visit(BoolLiteral(true));
+        }
+        out_->out(")");
+        out_->out(" opakuj", style_.controlKeyword_);
+
+        if (not f.inc_)
+        {
+            f.body_.accept(*this);
+            return;
+        }
+
+        // Increment is the last statement of each iteration.
+        auto inc        = ExpressionStatement(f.inc_);
+        auto statements = f.body_.statements_;
+        statements.push_back(&inc);
+        CompoundStatement(std::move(statements)).accept(*this);
     }
 
     auto PseudocodeGenerator::visit
@@ -990,48 +1364,23 @@ namespace fri
     auto PseudocodeGenerator::visit
         (VarDefCommon const& f) -> void
     {
-        using SingleLine = struct
-        {
-            bool val;
-        };
-
-        auto const make_out = [this, &f](auto const singleLine)
-        {
-            return [this, singleLine, &f]()
-            {
-                out_->out(f.name_, style_.variable_);
-                out_->out(": ");
-                f.type_->accept(*this);
-                if (f.initializer_)
-                {
-                    out_->out(" ");
-                    out_->out(bin_op_to_string(BinOpcode::Assign));
-                    if (singleLine.val)
-                    {
-                        out_->out(" ");
-                        f.initializer_->accept(*this);
-                    }
-                    else
-                    {
-                        out_->inc_indent();
-                        out_->wrap_line();
-                        f.initializer_->accept(*this);
-                        out_->dec_indent();
-                    }
-                }
-            };
-        };
-
-        auto const out_inline = make_out(SingleLine {true});
-        auto const out_wrapped = make_out(SingleLine {false});
-        if (this->try_output_length(out_inline) > 53)
-        {
-            out_wrapped();
-        }
-        else
+        // Definition is measured without what precedes it on the line,
+        // so it has less room than a declaration. Long initializer
+        // continues on the next line.
+        out_->begin_group(lineWidth_ > 21 ? lineWidth_ - 21 : 0);
+        out_->out(f.name_, style_.variable_);
+        out_->out(": ");
+        f.type_->accept(*this);
+        if (f.initializer_)
         {
-            out_inline();
+            out_->out(" ");
+            out_->out(bin_op_to_string(BinOpcode::Assign));
+            out_->soft_inc_indent();
+            out_->soft_line(" ");
+            f.initializer_->accept(*this);
+            out_->soft_dec_indent();
         }
+        out_->end_group();
     }
 
     auto PseudocodeGenerator::visit
@@ -1387,7 +1736,7 @@ namespace fri
 
         auto const out_type = [this, &m]()
         {
-            if (m.retType_->to_string() != "void")
+            if (not m.retType_->isVoid_)
             {
                 out_->out(": ");
                 m.retType_->accept(*this);
@@ -1585,57 +1934,32 @@ namespace fri
 
     template<class OutputName, class OutputType>
     auto PseudocodeGenerator::visit_decl
-        ( OutputName&&                        name
-        , std::vector<ParamDefinition> const& params
-        , OutputType&&                        type ) -> void
+        ( OutputName&&    name
+        , params_t const& params
+        , OutputType&&    type ) -> void
     {
-        // Outputs method header into single line.
-        auto const out_single_line = [this, &name, &params, &type]()
-        {
-            name();
-            out_->out("(");
-            this->visit_range(params, [this]()
-            {
-                out_->out(", ");
-            });
-            out_->out(")");
-            type();
-        };
-
-        // Outputs method header into multiple lines.
-        // Each parameter is on a separate line.
-        auto const out_multi_line = [this, &name, &params, &type]()
-        {
-            name();
-            out_->out("(");
-            if (not params.empty())
-            {
-                out_->inc_indent();
-            }
-            out_->wrap_line();
-            this->visit_range(params, [this]()
-            {
-                out_->out(",");
-                out_->wrap_line();
-            });
-            if (not params.empty())
-            {
-                out_->dec_indent();
-                out_->wrap_line();
-            }
-            out_->out(")");
-            type();
-        };
-
-        auto const col = this->try_output_length(out_single_line);
-        if (col > 74)
+        // Parameters go on separate lines if the header is too long.
+        out_->begin_group(lineWidth_);
+        name();
+        out_->out("(");
+        if (not params.empty())
         {
-            out_multi_line();
+            out_->soft_inc_indent();
         }
-        else
+        out_->soft_line("");
+        this->visit_range(params, [this]()
         {
-            out_single_line();
+            out_->out(",");
+            out_->soft_line(" ");
+        });
+        if (not params.empty())
+        {
+            out_->soft_dec_indent();
+            out_->soft_line("");
         }
+        out_->out(")");
+        type();
+        out_->end_group();
     }
 
     template<class Range>
@@ -1656,7 +1980,7 @@ namespace fri
     }
 
     auto PseudocodeGenerator::visit_args
-        (std::vector<std::unique_ptr<Expression>> const& as) -> void
+        (args_t const& as) -> void
     {
         this->visit_range(as, [this]()
         {
@@ -1700,67 +2024,24 @@ namespace fri
         }
     }
 
-    template<class LineOut>
-    auto PseudocodeGenerator::try_output_length
-        (LineOut&& o) -> std::size_t
-    {
-        auto const realOutput = out_;
-        auto dummyOutput = DummyCodePrinter(out_->current_indent());
-        out_ = &dummyOutput;
-        o();
-        auto const column = dummyOutput.get_column();
-        out_ = realOutput;
-        return column;
-    }
-
     auto PseudocodeGenerator::map_func_name
-        (std::string const& s) const -> std::string_view
+        (std::string_view const s) const -> std::string_view
     {
         namespace rs = std::ranges;
-        auto it = funcNames_.find(s);
-        return it == rs::end(funcNames_) ? s : (*it).second;
+        auto const& funcNames = func_names();
+        auto it = funcNames.find(s);
+        return it == rs::end(funcNames) ? s : (*it).second;
     }
 
-    ForVarDefVisitor::ForVarDefVisitor
-        (PseudocodeGenerator& v) :
-        real_ (&v)
+    auto generate_pseudocode
+        (TranslationUnit const& unit, ICodePrinter& printer, OutputSettings const& settings) -> void
     {
-    }
-
-    auto ForVarDefVisitor::visit
-        (VarDefinition const& v) -> void
-    {
-        real_->out_var_name(v.var_.name_);
-        real_->out_plain(": ");
-        v.var_.type_->accept(*real_);
-    }
-
-    ForFromVisitor::ForFromVisitor
-        (PseudocodeGenerator& v) :
-        real_ (&v)
-    {
-    }
-
-    auto ForFromVisitor::visit
-        (VarDefinition const& b) -> void
-    {
-        if (b.var_.initializer_)
+        auto decoratedPrinter = NumberedCodePrinter(printer, 3, settings.style.lineNumber_);
+        auto layoutPrinter    = LayoutCodePrinter(decoratedPrinter);
+        auto generator        = PseudocodeGenerator(layoutPrinter, settings.style, settings.outline, settings.lineWidth);
+        for (auto const& c : unit.get_classes())
         {
-            b.var_.initializer_->accept(*real_);
+            c->accept(generator);
         }
     }
-
-    ForToVisitor::ForToVisitor
-        (PseudocodeGenerator& v) :
-        real_ (&v)
-    {
-    }
-
-    auto ForToVisitor::visit
-        (BinaryOperator const& b) -> void
-    {
-        b.rhs_->accept(*real_);
-        real_->out_plain(" - ");
-        real_->visit(IntLiteral(1));
-    }
 }
\ No newline at end of file
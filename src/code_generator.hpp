@@ -5,6 +5,7 @@
 
 #include <cstdint>
 #include <fstream>
+#include <map>
 #include <ostream>
 #include <string_view>
 #include <unordered_map>
@@ -70,6 +71,8 @@ namespace fri
         unsigned int  indentSpaces = 2;
         std::string   font {"Consolas"};
         CodeStyleInfo style {};
+        bool          outline = false;
+        unsigned int  lineWidth = 74;
     };
 
     /**
@@ -154,6 +157,12 @@ namespace fri
         auto wrap_line      () -> void override;
         auto current_indent () const -> IndentState override;
 
+        /**
+         *  @brief Number of spaces printed at the beginning of a line
+         *  indented by @p s . Indentation is limited.
+         */
+        static auto indent_width (IndentState s) -> std::size_t;
+
     protected:
         auto get_indent () const -> std::string_view;
 
@@ -196,7 +205,7 @@ namespace fri
     class RtfCodePrinter : public CommonCodePrinter
     {
     public:
-        RtfCodePrinter   (std::ofstream&, OutputSettings const&);
+        RtfCodePrinter   (std::ostream&, OutputSettings const&);
         ~RtfCodePrinter  ();
 
         auto begin_line () -> void override;
@@ -220,33 +229,31 @@ namespace fri
         static auto encode (std::string_view) -> std::string;
 
     private:
-        std::ofstream*     ofst_;
+        std::ostream*      ost_;
         std::vector<Color> colors_;
     };
 
     /**
-     *  @brief /dev/null code printer. Used to mease how long a line would be.
+     *  @brief Prints code to a stream as plain text, ignores styles.
      */
-    class DummyCodePrinter : public CommonCodePrinter
+    class PlainCodePrinter : public CommonCodePrinter
     {
     public:
-        DummyCodePrinter (IndentState);
+        PlainCodePrinter (std::ostream&, OutputSettings const&);
 
         auto begin_line () -> void override;
         auto end_line   () -> void override;
         auto blank_line () -> void override;
         auto end_region () -> void override;
 
-        auto out (std::string_view) -> DummyCodePrinter& override;
-        auto out (std::string_view, TextStyle const&) -> DummyCodePrinter& override;
-
-        auto get_column () const -> std::size_t;
+        auto out (std::string_view) -> PlainCodePrinter& override;
+        auto out (std::string_view, TextStyle const&) -> PlainCodePrinter& override;
 
     private:
         using base = CommonCodePrinter;
 
     private:
-        std::size_t currentColumn_ {0};
+        std::ostream* ost_;
     };
 
     /**
@@ -285,6 +292,106 @@ namespace fri
         std::size_t       currentNum_;
     };
 
+    /**
+     *  @brief Decorates code printer with layout of groups. Group is printed
+     *  flat if it would end at most at its width, otherwise its soft lines
+     *  are wrapped and its soft indentation is applied. Column is counted
+     *  from the beginning of the group, lines started inside of the group
+     *  are counted from their indentation.
+     *
+     *  Output outside of groups is passed on immediately. Groups are kept
+     *  until the outermost one ends and then laid out in a single pass,
+     *  in which each group is measured once per level of indentation
+     *  it appears at.
+     */
+    class LayoutCodePrinter : public ICodePrinter
+    {
+    public:
+        LayoutCodePrinter (ICodePrinter&);
+
+        auto inc_indent () -> void override;
+        auto dec_indent () -> void override;
+        auto begin_line () -> void override;
+        auto end_line   () -> void override;
+        auto wrap_line  () -> void override;
+        auto blank_line () -> void override;
+        auto end_region () -> void override;
+
+        auto out (std::string_view) -> LayoutCodePrinter& override;
+        auto out (std::string_view, TextStyle const&) -> LayoutCodePrinter& override;
+
+        /**
+         *  @brief Indentation of output that was already passed on.
+         */
+        auto current_indent () const -> IndentState override;
+
+        /**
+         *  @brief Begins group that is wrapped if it would end past @p width .
+         */
+        auto begin_group (std::size_t width) -> void;
+        auto end_group   () -> void;
+
+        /**
+         *  @brief Prints @p flat if the group is flat, wraps line otherwise.
+         */
+        auto soft_line (std::string_view flat) -> void;
+
+        /**
+         *  @brief Changes indentation only if the group is wrapped.
+         */
+        auto soft_inc_indent () -> void;
+        auto soft_dec_indent () -> void;
+
+    private:
+        enum class Op : std::uint8_t
+        {
+            Out, OutStyled, IncIndent, DecIndent, BeginLine, EndLine, WrapLine,
+            BlankLine, EndRegion, BeginGroup, EndGroup, SoftLine, SoftIncIndent,
+            SoftDecIndent
+        };
+
+        /**
+         *  @brief Kept output. Text is stored in @c chars_ , @c size_ of
+         *  a group is its width and @c end_ is the index of its end.
+         */
+        struct Token
+        {
+            Op          op_;
+            TextStyle   style_ {};
+            std::size_t first_ {0};
+            std::size_t size_  {0};
+            std::size_t end_   {0};
+        };
+
+        /**
+         *  @brief How a group changes column and indentation.
+         */
+        struct Effect
+        {
+            bool        wrapped_;
+            bool        newLine_; // Column is set to @c columns_ , not advanced by it.
+            std::size_t columns_;
+            std::size_t level_;
+        };
+
+    private:
+        auto keep    (Op, std::string_view = {}, TextStyle const& = {}) -> void;
+        auto text    (Token const&) const -> std::string_view;
+        auto layout  (std::size_t group, std::size_t level) -> Effect;
+        auto measure (std::size_t group, std::size_t level, bool wrapped) -> Effect;
+        auto flush   () -> void;
+
+    private:
+        using layouts_t = std::map<std::pair<std::size_t, std::size_t>, Effect>;
+
+    private:
+        ICodePrinter*            decoree_;
+        std::vector<Token>       tokens_;
+        std::string              chars_;
+        std::vector<std::size_t> open_;
+        layouts_t                layouts_;
+    };
+
     // TODO use
     // struct IsInline
     // {
@@ -302,7 +409,12 @@ namespace fri
     class PseudocodeGenerator : public CodeVisitor
     {
     public:
-        PseudocodeGenerator (ICodePrinter&, CodeStyleInfo);
+        /**
+         *  @param outline if true, only class declarations are generated
+         *         without definitions of their members.
+         *  @param lineWidth width of declarations that are not wrapped.
+         */
+        PseudocodeGenerator (LayoutCodePrinter&, CodeStyleInfo, bool outline = false, std::size_t lineWidth = 74);
 
         auto visit (IntLiteral const&)           -> void override;
         auto visit (FloatLiteral const&)         -> void override;
@@ -310,6 +422,7 @@ namespace fri
         auto visit (NullLiteral const&)          -> void override;
         auto visit (BoolLiteral const&)          -> void override;
         auto visit (BinaryOperator const&)       -> void override;
+        auto visit (OperatorChain const&)        -> void override;
         auto visit (Parenthesis const&)          -> void override;
         auto visit (VarRef const&)               -> void override;
         auto visit (MemberVarRef const&)         -> void override;
@@ -373,6 +486,11 @@ namespace fri
         auto visit_member_base (Expression const&) -> void;
         auto visit_class_name  (Class const&) -> void;
 
+        /**
+         *  @brief Outputs for loop @p f as a loop with a condition.
+         */
+        auto out_cond_loop (ForLoop const& f) -> void;
+
         /**
          *  @brief Outputs declaration of method/constructor either into single
          *  line or multiple line if the decl is long.
@@ -381,12 +499,12 @@ namespace fri
          *  @tparam OutputType outputs `: int` or nothing for constructor.
          */
         template<class OutputName, class OutputType>
-        auto visit_decl (OutputName&&, std::vector<ParamDefinition> const&, OutputType&&) -> void;
+        auto visit_decl (OutputName&&, params_t const&, OutputType&&) -> void;
 
         template<class Range>
         auto output_range (Range&&, std::string_view, TextStyle const&) -> void;
 
-        auto visit_args (std::vector<std::unique_ptr<Expression>> const&) -> void;
+        auto visit_args (args_t const&) -> void;
 
         template<class Range, class OutputSep>
         auto visit_range (Range&&, OutputSep&&) -> void;
@@ -394,52 +512,24 @@ namespace fri
         template<class Range, class Visitor, class OutputSep>
         auto visit_range (Range&&, Visitor&&, OutputSep&&) -> void;
 
+        auto map_func_name (std::string_view) const -> std::string_view;
+
         /**
-         *  Temporarly swaps @c out_ for dummy, executes @c LineOut arg
-         *  and then returns length of the current line.
-         *  (If @c LineOut uses multiple lines, it returns length
-         *  of the last line. )
+         *  @brief Names of library functions in pseudocode. Shared by all generators.
          */
-        template<class LineOut>
-        auto try_output_length (LineOut&&) -> std::size_t;
-
-        auto map_func_name (std::string const&) const -> std::string_view;
+        static auto func_names () -> std::unordered_map<std::string_view, std::string_view> const&;
 
     private:
-        ICodePrinter* out_;
-        CodeStyleInfo style_;
-        std::unordered_map<std::string, std::string> funcNames_;
-    };
-
-    /**
-     *  @brief Visits variable definition or does nothing.
-     */
-    struct ForVarDefVisitor : public CodeVisitorAdapter
-    {
-        PseudocodeGenerator* real_;
-        ForVarDefVisitor(PseudocodeGenerator&);
-        auto visit (VarDefinition const&) -> void override;
-    };
-
-    /**
-     *  @brief Visits for loop condition.
-     */
-    struct ForFromVisitor : public CodeVisitorAdapter
-    {
-        PseudocodeGenerator* real_;
-        ForFromVisitor(PseudocodeGenerator&);
-        auto visit (VarDefinition const&) -> void override;
+        LayoutCodePrinter* out_;
+        CodeStyleInfo      style_;
+        bool               outline_;
+        std::size_t        lineWidth_;
     };
 
     /**
-     *  @brief Visits for loop condition.
+     *  @brief Generates numbered pseudocode of all classes from @p unit .
      */
-    struct ForToVisitor : public CodeVisitorAdapter
-    {
-        PseudocodeGenerator* real_;
-        ForToVisitor(PseudocodeGenerator&);
-        auto visit (BinaryOperator const&) -> void override;
-    };
+    auto generate_pseudocode (TranslationUnit const&, ICodePrinter&, OutputSettings const&) -> void;
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,279 @@
+#include "command_line.hpp"
+#include "utils.hpp"
+
+#include <iostream>
+#include <string_view>
+#include <utility>
+
+namespace fri
+{
+    namespace
+    {
+        /**
+         *  @brief Parses options and positional arguments starting at @p first .
+         */
+        auto parse_arguments
+            (CommandLine cmd, int const first, int const argc, char** argv) -> std::optional<CommandLine>
+        {
+            auto i = first;
+            auto const next_value = [&i, argc, argv](std::string_view const option)
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "Missing value for option: " << option << '\n';
+                    return std::optional<std::string>();
+                }
+                ++i;
+                return std::optional<std::string>(argv[i]);
+            };
+
+            auto const next_count = [&next_value](std::string_view const option)
+            {
+                auto const val = next_value(option);
+                if (not val)
+                {
+                    return std::optional<unsigned>();
+                }
+                auto const count = parse<unsigned>(*val);
+                if (not count or count.unsafe_get() == 0)
+                {
+                    std::cerr << "Invalid value of option " << option << ": " << *val << '\n';
+                    return std::optional<unsigned>();
+                }
+                return std::optional<unsigned>(count.unsafe_get());
+            };
+
+            for (; i < argc; ++i)
+            {
+                auto const arg = std::string_view(argv[i]);
+                if (arg == "-p")
+                {
+                    auto const val = next_value(arg);
+                    if (not val)
+                    {
+                        return std::nullopt;
+                    }
+                    cmd.buildDir_ = *val;
+                }
+                else if (arg == "-o")
+                {
+                    auto const val = next_value(arg);
+                    if (not val)
+                    {
+                        return std::nullopt;
+                    }
+                    cmd.output_ = *val;
+                }
+                else if (arg == "--pch")
+                {
+                    auto const val = next_value(arg);
+                    if (not val)
+                    {
+                        return std::nullopt;
+                    }
+                    cmd.pch_ = *val;
+                }
+                else if (arg == "--ast-cache")
+                {
+                    auto const val = next_value(arg);
+                    if (not val)
+                    {
+                        return std::nullopt;
+                    }
+                    cmd.astCache_ = *val;
+                }
+                else if (arg == "--unit-cache")
+                {
+                    auto const val = next_value(arg);
+                    if (not val)
+                    {
+                        return std::nullopt;
+                    }
+                    cmd.unitCache_ = *val;
+                }
+                else if (arg == "--watch")
+                {
+                    cmd.watch_ = true;
+                }
+                else if (arg == "--verbose")
+                {
+                    cmd.verbose_ = true;
+                }
+                else if (arg == "--outline")
+                {
+                    cmd.outline_ = true;
+                }
+                else if (arg == "--stats")
+                {
+                    cmd.stats_ = true;
+                }
+                else if (arg == "-j" or arg == "--jobs")
+                {
+                    auto const val = next_count(arg);
+                    if (not val)
+                    {
+                        return std::nullopt;
+                    }
+                    cmd.jobs_ = *val;
+                }
+                else if (arg == "--processes")
+                {
+                    auto const val = next_count(arg);
+                    if (not val)
+                    {
+                        return std::nullopt;
+                    }
+                    cmd.processes_ = *val;
+                }
+                else if (arg == "--timeout")
+                {
+                    auto const val = next_count(arg);
+                    if (not val)
+                    {
+                        return std::nullopt;
+                    }
+                    cmd.timeout_ = *val;
+                }
+                else if (arg.starts_with("-"))
+                {
+                    std::cerr << "Unknown option: " << arg << '\n';
+                    return std::nullopt;
+                }
+                else
+                {
+                    cmd.inputs_.emplace_back(arg);
+                }
+            }
+            return cmd;
+        }
+
+        auto check_single
+            (CommandLine cmd) -> std::optional<CommandLine>
+        {
+            if (cmd.inputs_.empty())
+            {
+                std::cerr << "Input file path not provided." << '\n';
+                return std::nullopt;
+            }
+
+            // Output path may be given either as an option or as a second argument.
+            if (cmd.inputs_.size() == 2 and not cmd.output_)
+            {
+                cmd.output_ = std::move(cmd.inputs_.back());
+                cmd.inputs_.pop_back();
+            }
+
+            if (cmd.inputs_.size() > 1)
+            {
+                std::cerr << "Too many input files, use --batch to process multiple files." << '\n';
+                return std::nullopt;
+            }
+
+            if (cmd.watch_ and (cmd.astCache_ or cmd.unitCache_))
+            {
+                std::cerr << "Option --watch keeps the input parsed, caches can not be used." << '\n';
+                return std::nullopt;
+            }
+
+            if (cmd.watch_ and cmd.stats_)
+            {
+                std::cerr << "Options --watch and --stats can not be combined." << '\n';
+                return std::nullopt;
+            }
+            return cmd;
+        }
+
+        auto check_batch
+            (CommandLine cmd) -> std::optional<CommandLine>
+        {
+            if (not cmd.output_)
+            {
+                std::cerr << "Output directory not provided." << '\n';
+                return std::nullopt;
+            }
+
+            if (cmd.inputs_.empty())
+            {
+                std::cerr << "Input file paths not provided." << '\n';
+                return std::nullopt;
+            }
+
+            if (cmd.jobs_ > 1 and cmd.processes_ > 0)
+            {
+                std::cerr << "Options --jobs and --processes can not be combined." << '\n';
+                return std::nullopt;
+            }
+
+            if (cmd.unitCache_ or cmd.watch_ or cmd.stats_)
+            {
+                std::cerr << "Options --unit-cache, --watch and --stats are supported only for a single input." << '\n';
+                return std::nullopt;
+            }
+            return cmd;
+        }
+
+        auto check_build_pch
+            (CommandLine cmd) -> std::optional<CommandLine>
+        {
+            if (cmd.inputs_.size() != 1)
+            {
+                std::cerr << "Exactly one header must be provided." << '\n';
+                return std::nullopt;
+            }
+
+            if (not cmd.output_)
+            {
+                std::cerr << "Precompiled header path not provided." << '\n';
+                return std::nullopt;
+            }
+            return cmd;
+        }
+
+        auto check_serve
+            (CommandLine cmd) -> std::optional<CommandLine>
+        {
+            if (cmd.inputs_.size() != 1)
+            {
+                std::cerr << "Exactly one socket path must be provided." << '\n';
+                return std::nullopt;
+            }
+
+            if (cmd.output_ or cmd.astCache_ or cmd.unitCache_ or cmd.watch_ or cmd.stats_ or cmd.processes_ > 0)
+            {
+                std::cerr << "Only options --pch, --jobs and --outline are supported by --serve." << '\n';
+                return std::nullopt;
+            }
+            return cmd;
+        }
+    }
+
+    auto parse_command_line
+        (int const argc, char** argv) -> std::optional<CommandLine>
+    {
+        auto cmd        = CommandLine {};
+        auto const mode = argc > 1 ? std::string_view(argv[1]) : std::string_view();
+        if (mode == "--batch")
+        {
+            cmd.mode_   = RunMode::Batch;
+            auto parsed = parse_arguments(std::move(cmd), 2, argc, argv);
+            return parsed ? check_batch(std::move(*parsed)) : std::nullopt;
+        }
+
+        if (mode == "--build-pch")
+        {
+            cmd.mode_   = RunMode::BuildPch;
+            auto parsed = parse_arguments(std::move(cmd), 2, argc, argv);
+            return parsed ? check_build_pch(std::move(*parsed)) : std::nullopt;
+        }
+
+        if (mode == "--serve")
+        {
+            cmd.mode_   = RunMode::Serve;
+            auto parsed = parse_arguments(std::move(cmd), 2, argc, argv);
+            return parsed ? check_serve(std::move(*parsed)) : std::nullopt;
+        }
+
+        auto parsed = parse_arguments(std::move(cmd), 1, argc, argv);
+        return parsed ? check_single(std::move(*parsed)) : std::nullopt;
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef FRI_COMMAND_LINE_HPP
+#define FRI_COMMAND_LINE_HPP
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace fri
+{
+    /**
+     *  @brief What the program should do.
+     */
+    enum class RunMode
+    {
+        Single, Batch, BuildPch, Serve
+    };
+
+    /**
+     *  @brief Parsed command line arguments.
+     */
+    struct CommandLine
+    {
+        RunMode                    mode_ {RunMode::Single};
+        std::vector<std::string>   inputs_;
+        std::optional<std::string> output_ {};
+        std::optional<std::string> pch_ {};
+        std::optional<std::string> astCache_ {};
+        std::optional<std::string> unitCache_ {};
+        bool                       watch_ {false};
+        bool                       verbose_ {false};
+        bool                       outline_ {false};
+        bool                       stats_ {false};
+        std::string                buildDir_ {};
+        unsigned                   jobs_ {1};
+        unsigned                   processes_ {0};
+        unsigned                   timeout_ {120};
+    };
+
+    /**
+     *  @brief Parses command line arguments. Prints an error and returns
+     *  nullopt if the arguments are invalid.
+     *
+     *  Usage:
+     *  generate-pseudocode [--pch <pch>] [--ast-cache <dir>] [--unit-cache <dir>] [--jobs <n>]
+     *                      [--stats] <input> [output]
+     *  generate-pseudocode --watch [--jobs <n>] <input> [output]
+     *  generate-pseudocode --batch [-p <build dir>] [--pch <pch>] [--ast-cache <dir>] [--jobs <n>]
+     *                      -o <output dir> <input>...
+     *  generate-pseudocode --batch [-p <build dir>] [--pch <pch>] [--ast-cache <dir>] --processes <n>
+     *                      [--timeout <seconds>] -o <output dir> <input>...
+     *  generate-pseudocode --build-pch <header> -o <pch>
+     *  generate-pseudocode --serve <socket> [--pch <pch>] [--jobs <n>]
+     *
+     *  Precompiled header given by --pch is used only if it is up to date,
+     *  otherwise the inputs are parsed without it. ASTs of inputs are stored
+     *  in the directory given by --ast-cache and reused while the inputs
+     *  and files they include do not change. Extracted code is stored in the
+     *  directory given by --unit-cache and reused while the preprocessed
+     *  input does not change. With --watch the output is regenerated each
+     *  time the input or one of the files it includes changes. For a single
+     *  input, --jobs gives the number of threads that extract method bodies
+     *  once the input is parsed. With --serve
+     *  requests are served on the given Unix domain socket by n workers.
+     *  Option --verbose is accepted in all modes, it prints all warnings
+     *  of clang and dumps constructs that could not be extracted. Option
+     *  --outline is accepted in all modes but --build-pch, only declarations
+     *  of classes are then generated. With --stats the time of extraction,
+     *  peak memory usage and size of the extracted code are printed to the
+     *  standard error output, it is accepted only for a single input.
+     */
+    auto parse_command_line (int argc, char** argv) -> std::optional<CommandLine>;
+}
+
+#endif
@@ -0,0 +1,104 @@
+#include "file_manifest.hpp"
+#include "utils.hpp"
+
+#include <fstream>
+
+namespace fri
+{
+    auto hash_file
+        (std::string const& path) -> std::optional<std::uint64_t>
+    {
+        auto ifst = std::ifstream(path, std::ios::binary);
+        if (not ifst.is_open())
+        {
+            return std::nullopt;
+        }
+
+        auto hash   = fnv1a({});
+        auto buffer = std::string(64 * 1024, '\0');
+        while (ifst)
+        {
+            ifst.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            hash = fnv1a(std::string_view(buffer.data(), static_cast<std::size_t>(ifst.gcount())), hash);
+        }
+        return ifst.bad() ? std::nullopt : std::optional<std::uint64_t>(hash);
+    }
+
+// FileManifest definitions:
+
+    auto FileManifest::capture
+        (std::uint64_t const key, std::vector<std::string> const& files) -> std::optional<FileManifest>
+    {
+        auto manifest = FileManifest();
+        manifest.key_ = key;
+        for (auto const& file : files)
+        {
+            auto const hash = hash_file(file);
+            if (not hash)
+            {
+                return std::nullopt;
+            }
+            manifest.entries_.emplace_back(Entry {file, *hash});
+        }
+        return manifest;
+    }
+
+    auto FileManifest::load
+        (std::string const& path) -> std::optional<FileManifest>
+    {
+        auto ifst = std::ifstream(path);
+        if (not ifst.is_open())
+        {
+            return std::nullopt;
+        }
+
+        // First line is the key, each following line is a hash and a path.
+        auto manifest = FileManifest();
+        if (not (ifst >> std::hex >> manifest.key_))
+        {
+            return std::nullopt;
+        }
+
+        auto entry = Entry {};
+        while (ifst >> std::hex >> entry.hash_)
+        {
+            ifst.ignore(1);
+            if (not std::getline(ifst, entry.path_))
+            {
+                return std::nullopt;
+            }
+            manifest.entries_.emplace_back(std::move(entry));
+        }
+        return ifst.eof() ? std::optional<FileManifest>(std::move(manifest)) : std::nullopt;
+    }
+
+    auto FileManifest::save
+        (std::string const& path) const -> bool
+    {
+        auto ofst = std::ofstream(path);
+        ofst << std::hex << key_ << '\n';
+        for (auto const& entry : entries_)
+        {
+            ofst << entry.hash_ << ' ' << entry.path_ << '\n';
+        }
+        return static_cast<bool>(ofst);
+    }
+
+    auto FileManifest::is_current
+        (std::uint64_t const key) const -> bool
+    {
+        if (key != key_)
+        {
+            return false;
+        }
+
+        for (auto const& entry : entries_)
+        {
+            if (hash_file(entry.path_) != entry.hash_)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
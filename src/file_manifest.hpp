@@ -0,0 +1,53 @@
+#ifndef FRI_FILE_MANIFEST_HPP
+#define FRI_FILE_MANIFEST_HPP
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace fri
+{
+    /**
+     *  @brief Hashes content of a file. Returns nullopt if it can not be read.
+     */
+    auto hash_file (std::string const& path) -> std::optional<std::uint64_t>;
+
+    /**
+     *  @brief Content hashes of files that a generated file (e.g. precompiled
+     *  header) was built from. Tells whether the generated file is stale.
+     */
+    class FileManifest
+    {
+    public:
+        /**
+         *  @brief Hashes current content of @p files .
+         *  @param key identifies options the generated file was built with.
+         *  @return nullopt if any of the files can not be read.
+         */
+        static auto capture ( std::uint64_t                   key
+                            , std::vector<std::string> const& files ) -> std::optional<FileManifest>;
+
+        static auto load (std::string const& path) -> std::optional<FileManifest>;
+
+        auto save (std::string const& path) const -> bool;
+
+        /**
+         *  @brief Checks that @p key matches and that none of the files changed.
+         */
+        auto is_current (std::uint64_t key) const -> bool;
+
+    private:
+        struct Entry
+        {
+            std::string   path_;
+            std::uint64_t hash_;
+        };
+
+    private:
+        std::uint64_t      key_ {0};
+        std::vector<Entry> entries_;
+    };
+}
+
+#endif
@@ -0,0 +1,128 @@
+#include "file_watcher.hpp"
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace fri
+{
+    FileWatcher::FileWatcher
+        () :
+        fd_ (::inotify_init1(IN_CLOEXEC))
+    {
+        if (fd_ < 0)
+        {
+            std::cerr << "Failed to initialize inotify: " << std::strerror(errno) << '\n';
+        }
+    }
+
+    FileWatcher::~FileWatcher
+        ()
+    {
+        if (fd_ >= 0)
+        {
+            ::close(fd_);
+        }
+    }
+
+    auto FileWatcher::watch
+        (std::vector<std::string> const& files) -> bool
+    {
+        if (fd_ < 0)
+        {
+            return false;
+        }
+
+        auto constexpr Mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE;
+        auto ok = true;
+        for (auto const& file : files)
+        {
+            auto const path = std::filesystem::absolute(file).lexically_normal();
+            if (not files_.insert(path.string()).second)
+            {
+                continue;
+            }
+
+            // Adding the same directory again returns the same descriptor.
+            auto const directory = path.parent_path().string();
+            auto const wd = ::inotify_add_watch(fd_, directory.c_str(), Mask);
+            if (wd < 0)
+            {
+                std::cerr << "Failed to watch directory: " << directory << '\n';
+                ok = false;
+                continue;
+            }
+            directories_.emplace(wd, directory);
+        }
+        return ok;
+    }
+
+    auto FileWatcher::wait_for_change
+        (std::chrono::milliseconds const settle) -> bool
+    {
+        if (fd_ < 0)
+        {
+            return false;
+        }
+
+        auto changed = false;
+        auto pfd     = pollfd {fd_, POLLIN, 0};
+        while (not changed)
+        {
+            if (::poll(&pfd, 1, -1) < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                std::cerr << "Failed to wait for changes: " << std::strerror(errno) << '\n';
+                return false;
+            }
+            changed = this->read_events();
+        }
+
+        // Swallow the rest of the change.
+        while (::poll(&pfd, 1, static_cast<int>(settle.count())) > 0)
+        {
+            this->read_events();
+        }
+        return true;
+    }
+
+    auto FileWatcher::read_events
+        () -> bool
+    {
+        alignas(inotify_event) auto buffer = std::array<char, 16 * 1024>();
+        auto const size = ::read(fd_, buffer.data(), buffer.size());
+        if (size <= 0)
+        {
+            return false;
+        }
+
+        auto changed = false;
+        auto offset  = std::size_t {0};
+        while (offset < static_cast<std::size_t>(size))
+        {
+            auto event = inotify_event {};
+            std::memcpy(&event, buffer.data() + offset, sizeof(inotify_event));
+            auto const name = buffer.data() + offset + sizeof(inotify_event);
+            offset += sizeof(inotify_event) + event.len;
+
+            auto const it = directories_.find(event.wd);
+            if (event.len == 0 or it == std::end(directories_))
+            {
+                continue;
+            }
+
+            auto const path = (std::filesystem::path(it->second) / name).string();
+            changed = changed or files_.contains(path);
+        }
+        return changed;
+    }
+}
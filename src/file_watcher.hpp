@@ -0,0 +1,54 @@
+#ifndef FRI_FILE_WATCHER_HPP
+#define FRI_FILE_WATCHER_HPP
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace fri
+{
+    /**
+     *  @brief Waits for changes of a set of files using inotify.
+     *  Directories of the files are watched rather than the files themselves,
+     *  so that files that editors replace on save are noticed too.
+     */
+    class FileWatcher
+    {
+    public:
+        FileWatcher ();
+        ~FileWatcher ();
+
+        FileWatcher (FileWatcher const&) = delete;
+        auto operator= (FileWatcher const&) -> FileWatcher& = delete;
+
+        /**
+         *  @brief Adds @p files to the watched files.
+         *  @return false if some of them can not be watched.
+         */
+        auto watch (std::vector<std::string> const& files) -> bool;
+
+        /**
+         *  @brief Blocks until one of the watched files changes. Changes that
+         *  follow within @p settle are reported as the same change, since
+         *  editors often write a file in multiple steps.
+         *  @return false if waiting failed.
+         */
+        auto wait_for_change (std::chrono::milliseconds settle) -> bool;
+
+    private:
+        /**
+         *  @brief Reads available events.
+         *  @return true if any of them is a change of a watched file.
+         */
+        auto read_events () -> bool;
+
+    private:
+        int                                  fd_;
+        std::unordered_map<int, std::string> directories_;
+        std::unordered_set<std::string>      files_;
+    };
+}
+
+#endif
@@ -0,0 +1,1763 @@
+#include "flat_code.hpp"
+
+#include "type_pool.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace fri
+{
+    namespace
+    {
+        /**
+         *  @brief Kind of a node of the flat image. Besides nodes of the abstract
+         *  code model there are kinds for parts of classes, names and lists.
+         */
+        enum class FlatKind : std::uint8_t
+        {
+            IntLiteral, FloatLiteral, StringLiteral, NullLiteral, BoolLiteral,
+            BinaryOperator, OperatorChain, UnaryOperator, Parenthesis, VarRef, MemberVarRef,
+            New, FunctionCall, ConstructorCall, DestructorCall, MemberFunctionCall,
+            ExpressionCall, This, IfExpression, Lambda,
+
+            PrimType, CustomType, TemplatedType, Indirection, Function, Nested,
+
+            Delete, VarDefinition, CompoundStatement, Return, If, ExpressionStatement,
+            ForLoop, WhileLoop, DoWhileLoop, Break, Case, Switch, Throw,
+
+            Class, Method, Constructor, Destructor, Param, Field, BaseInit, MemberInit,
+            Alias, Name, List
+        };
+
+        /**
+         *  @brief Node of the flat image. Children of the node are @c count_
+         *  consecutive node indices starting at @c first_ in the array of children.
+         *  Depending on the kind, @c value_ indexes the array of symbols, integers
+         *  or floats and @c flags_ and @c op_ hold constness, opcodes etc.
+         */
+        struct FlatNode
+        {
+            FlatKind      kind_;
+            std::uint8_t  flags_;
+            std::uint16_t op_;
+            std::uint32_t value_;
+            std::uint32_t first_;
+            std::uint32_t count_;
+        };
+
+        /**
+         *  @brief Symbol of the flat image, a range in the array of characters.
+         */
+        struct FlatSymbol
+        {
+            std::uint32_t offset_;
+            std::uint32_t size_;
+        };
+
+        /**
+         *  @brief Header of the flat image, numbers of elements of its arrays.
+         */
+        struct FlatHeader
+        {
+            std::uint32_t magic_;
+            std::uint32_t nodes_;
+            std::uint32_t floats_;
+            std::uint32_t ints_;
+            std::uint32_t children_;
+            std::uint32_t symbols_;
+            std::uint32_t chars_;
+            std::uint32_t reserved_;
+        };
+
+        /**
+         *  @brief Child index of a missing node.
+         */
+        inline auto constexpr NoNode = std::uint32_t {0xFFFFFFFF};
+
+        /**
+         *  @brief Read-only view of a flat image of a translation unit.
+         *
+         *  The image is a header followed by arrays of nodes, floats, integers,
+         *  children, symbols and characters. Nodes refer to each other by 32-bit
+         *  indices only, so the image can be written to a file and mapped back
+         *  at any address. Node 0 is a list of classes, children always follow
+         *  their parent.
+         */
+        class FlatView
+        {
+        public:
+            /**
+             *  @brief Checks the header and sizes of arrays of @p image .
+             *  @return nullopt if @p image is truncated or written by other version.
+             */
+            static auto map (std::string_view image) -> std::optional<FlatView>;
+
+            auto node_count   () const -> std::uint32_t;
+            auto child_count  () const -> std::uint32_t;
+            auto symbol_count () const -> std::uint32_t;
+            auto int_count    () const -> std::uint32_t;
+            auto float_count  () const -> std::uint32_t;
+
+            auto node     (std::uint32_t) const -> FlatNode;
+            auto child    (std::uint32_t) const -> std::uint32_t;
+            auto symbol   (std::uint32_t) const -> std::string_view;
+            auto integer  (std::uint32_t) const -> std::int64_t;
+            auto floating (std::uint32_t) const -> double;
+
+        private:
+            FlatView (std::string_view image, FlatHeader const& header);
+
+            template<class T>
+            auto read (std::size_t offset) const -> T;
+
+        private:
+            std::string_view image_;
+            FlatHeader       header_;
+            std::size_t      floats_;
+            std::size_t      ints_;
+            std::size_t      children_;
+            std::size_t      symbols_;
+            std::size_t      chars_;
+        };
+
+        /**
+         *  @brief Written at the beginning of each image. Must be changed
+         *  along with the format, so that old images are not read.
+         */
+        auto constexpr Magic = std::uint32_t {0x46524905};
+
+        static_assert(std::is_trivially_copyable_v<FlatNode>);
+        static_assert(std::is_trivially_copyable_v<FlatSymbol>);
+        static_assert(std::is_trivially_copyable_v<FlatHeader>);
+        static_assert(sizeof(FlatNode) == 16);
+
+        /**
+         *  @brief Flags of nodes.
+         */
+        auto constexpr IsConstFlag   = std::uint8_t {1};
+        auto constexpr TrueFlag      = std::uint8_t {1};
+        auto constexpr TypeArgFlag   = std::uint8_t {2};
+        auto constexpr InterfaceFlag = std::uint8_t {4};
+
+        /**
+         *  @brief Flags of type nodes.
+         */
+        auto type_flags (Type const& t) -> std::uint8_t
+        {
+            return static_cast<std::uint8_t>( (t.is_const() ? IsConstFlag : 0)
+                                             | (t.isInterface_ ? InterfaceFlag : 0) );
+        }
+
+        /**
+         *  @brief Writes each node before its children, so that children follow
+         *  their parent. Child nodes get their index when the parent is written
+         *  and are written later from a stack, so that nesting of the code is
+         *  not limited by the call stack.
+         */
+        class FlatWriter : public CodeVisitor
+        {
+        public:
+            auto write_unit (TranslationUnit const&) -> void;
+            auto image      () const -> std::string;
+
+            auto visit (IntLiteral const&)          -> void override;
+            auto visit (FloatLiteral const&)        -> void override;
+            auto visit (StringLiteral const&)       -> void override;
+            auto visit (NullLiteral const&)         -> void override;
+            auto visit (BoolLiteral const&)         -> void override;
+            auto visit (BinaryOperator const&)      -> void override;
+            auto visit (OperatorChain const&)       -> void override;
+            auto visit (Parenthesis const&)         -> void override;
+            auto visit (VarRef const&)              -> void override;
+            auto visit (MemberVarRef const&)        -> void override;
+            auto visit (UnaryOperator const&)       -> void override;
+            auto visit (New const&)                 -> void override;
+            auto visit (FunctionCall const&)        -> void override;
+            auto visit (ConstructorCall const&)     -> void override;
+            auto visit (DestructorCall const&)      -> void override;
+            auto visit (MemberFunctionCall const&)  -> void override;
+            auto visit (ExpressionCall const&)      -> void override;
+            auto visit (This const&)                -> void override;
+            auto visit (IfExpression const&)        -> void override;
+            auto visit (Lambda const&)              -> void override;
+
+            auto visit (PrimType const&)            -> void override;
+            auto visit (CustomType const&)          -> void override;
+            auto visit (TemplatedType const&)       -> void override;
+            auto visit (Indirection const&)         -> void override;
+            auto visit (Function const&)            -> void override;
+            auto visit (Nested const&)              -> void override;
+
+            auto visit (Class const&)               -> void override;
+            auto visit (Method const&)              -> void override;
+            auto visit (VarDefCommon const&)        -> void override;
+            auto visit (FieldDefinition const&)     -> void override;
+            auto visit (ParamDefinition const&)     -> void override;
+            auto visit (VarDefinition const&)       -> void override;
+            auto visit (ForLoop const&)             -> void override;
+            auto visit (WhileLoop const&)           -> void override;
+            auto visit (DoWhileLoop const&)         -> void override;
+            auto visit (CompoundStatement const&)   -> void override;
+            auto visit (ExpressionStatement const&) -> void override;
+            auto visit (Return const&)              -> void override;
+            auto visit (If const&)                  -> void override;
+            auto visit (Delete const&)              -> void override;
+            auto visit (Throw const&)               -> void override;
+            auto visit (Break const&)               -> void override;
+            auto visit (Case const&)                -> void override;
+            auto visit (Switch const&)              -> void override;
+
+        private:
+            using indices_t = std::vector<std::uint32_t>;
+
+            struct Pending
+            {
+                void const*   node_;
+                void        (*accept_) (void const*, CodeVisitor&);
+                std::uint32_t index_;
+            };
+
+            auto write_pending () -> void;
+
+            auto add    ( FlatKind      kind
+                        , std::uint32_t value = 0
+                        , std::uint8_t  flags = 0
+                        , std::uint16_t op    = 0 ) -> std::uint32_t;
+            auto finish (std::uint32_t index, indices_t const& children) -> void;
+            auto symbol (std::string_view) -> std::uint32_t;
+            auto name   (std::string_view) -> std::uint32_t;
+
+            template<class Node>
+            auto node (Node const*) -> std::uint32_t;
+
+            template<class Range>
+            auto append (indices_t&, Range const&) -> void;
+
+            template<class Range, class F>
+            auto list (Range const&, F&&) -> std::uint32_t;
+
+            auto compound (CompoundStatement const&)                -> std::uint32_t;
+            auto compound (std::optional<CompoundStatement> const&) -> std::uint32_t;
+            auto params   (params_t const&)                         -> std::uint32_t;
+            auto var      (FlatKind, VarDefCommon const&)           -> void;
+
+        private:
+            std::vector<FlatNode>                          nodes_;
+            std::vector<double>                            floats_;
+            std::vector<std::int64_t>                      ints_;
+            std::vector<std::uint32_t>                     children_;
+            std::vector<FlatSymbol>                        symbols_;
+            std::string                                    chars_;
+            std::unordered_map<std::string, std::uint32_t> symbolIndices_;
+            std::vector<Pending>                           pending_;
+            std::uint32_t                                  slot_ {NoNode};
+            std::uint32_t                                  last_ {NoNode};
+        };
+
+        /**
+         *  @brief Rebuilds nodes from an image. Each child must follow its
+         *  parent, so that a malformed image can not make reading loop.
+         *  Expressions, statements and types are thus built from the last
+         *  node to the first, each after its children, without recursion.
+         *  Other nodes are read by their parents.
+         *  Reading stops being valid on the first malformed node, all
+         *  following reads return empty values.
+         */
+        class FlatReader
+        {
+        public:
+            explicit FlatReader (FlatView const& view);
+            auto read_unit () -> std::optional<TranslationUnit>;
+
+        private:
+            auto fetch  (std::uint32_t index) -> FlatNode;
+            auto child  (std::uint32_t parent, FlatNode const&, std::uint32_t k) -> std::uint32_t;
+            auto symbol (FlatNode const&) -> Symbol;
+            auto opcode (FlatNode const&, std::uint16_t max) -> std::uint16_t;
+
+            auto build_nodes     () -> void;
+            auto build_expression (std::uint32_t) -> Expression*;
+            auto build_type       (std::uint32_t) -> Type*;
+            auto build_statement  (std::uint32_t) -> Statement*;
+
+            auto read_expression  (std::uint32_t) -> Expression*;
+            auto read_expressions (std::uint32_t, FlatNode const&, std::uint32_t from) -> args_t;
+            auto read_type        (std::uint32_t) -> Type*;
+            auto read_types       (std::uint32_t, FlatNode const&, std::uint32_t from) -> std::vector<Type*>;
+            auto read_statement   (std::uint32_t) -> Statement*;
+
+            template<class T, class Seq = std::vector<T>, class F>
+            auto read_list (std::uint32_t, F&&) -> Seq;
+
+            auto read_compound          (std::uint32_t) -> CompoundStatement;
+            auto read_optional_compound (std::uint32_t) -> std::optional<CompoundStatement>;
+            auto read_var               (std::uint32_t, FlatKind) -> VarDefCommon;
+            auto read_params            (std::uint32_t) -> params_t;
+            auto read_case              (std::uint32_t) -> Case;
+            auto read_method            (std::uint32_t) -> Method;
+            auto read_constructor       (std::uint32_t) -> Constructor;
+            auto read_class             (std::uint32_t) -> Class*;
+            auto read_name              (std::uint32_t) -> std::string;
+
+            auto fail () -> void;
+
+        private:
+            FlatView const*          view_;
+            std::unique_ptr<Arena>   arena_;
+            TypePool                 types_;
+            std::vector<Symbol>      symbols_;
+            std::vector<Expression*> expressions_;
+            std::vector<Type*>       typeNodes_;
+            std::vector<Statement*>  statements_;
+            bool                     valid_;
+        };
+
+// FlatWriter definitions:
+
+        auto FlatWriter::write_unit
+            (TranslationUnit const& unit) -> void
+        {
+            auto const root = this->add(FlatKind::List);
+            auto classes    = indices_t();
+            for (auto const c : unit.get_classes())
+            {
+                c->accept(*this);
+                classes.push_back(last_);
+                this->write_pending();
+            }
+            this->finish(root, classes);
+        }
+
+        auto FlatWriter::write_pending
+            () -> void
+        {
+            while (not pending_.empty())
+            {
+                auto const p = pending_.back();
+                pending_.pop_back();
+                slot_ = p.index_;
+                p.accept_(p.node_, *this);
+            }
+        }
+
+        auto FlatWriter::image
+            () const -> std::string
+        {
+            auto const header = FlatHeader
+                { .magic_    = Magic
+                , .nodes_    = static_cast<std::uint32_t>(nodes_.size())
+                , .floats_   = static_cast<std::uint32_t>(floats_.size())
+                , .ints_     = static_cast<std::uint32_t>(ints_.size())
+                , .children_ = static_cast<std::uint32_t>(children_.size())
+                , .symbols_  = static_cast<std::uint32_t>(symbols_.size())
+                , .chars_    = static_cast<std::uint32_t>(chars_.size())
+                , .reserved_ = 0 };
+
+            // Arrays are ordered by alignment, so that they need no padding.
+            auto out = std::string();
+            auto const append = [&out](void const* const data, std::size_t const size)
+            {
+                out.append(static_cast<char const*>(data), size);
+            };
+            append(&header,          sizeof(FlatHeader));
+            append(nodes_.data(),    nodes_.size() * sizeof(FlatNode));
+            append(floats_.data(),   floats_.size() * sizeof(double));
+            append(ints_.data(),     ints_.size() * sizeof(std::int64_t));
+            append(children_.data(), children_.size() * sizeof(std::uint32_t));
+            append(symbols_.data(),  symbols_.size() * sizeof(FlatSymbol));
+            append(chars_.data(),    chars_.size());
+            return out;
+        }
+
+        auto FlatWriter::add
+            ( FlatKind      const kind
+            , std::uint32_t const value
+            , std::uint8_t  const flags
+            , std::uint16_t const op ) -> std::uint32_t
+        {
+            // First node added by a pending node is the node itself.
+            if (slot_ != NoNode)
+            {
+                auto const index = std::exchange(slot_, NoNode);
+                nodes_[index] = FlatNode {kind, flags, op, value, 0, 0};
+                return index;
+            }
+            nodes_.push_back(FlatNode {kind, flags, op, value, 0, 0});
+            return static_cast<std::uint32_t>(nodes_.size() - 1);
+        }
+
+        auto FlatWriter::finish
+            (std::uint32_t const index, indices_t const& children) -> void
+        {
+            nodes_[index].first_ = static_cast<std::uint32_t>(children_.size());
+            nodes_[index].count_ = static_cast<std::uint32_t>(children.size());
+            children_.insert(std::end(children_), std::begin(children), std::end(children));
+            last_ = index;
+        }
+
+        auto FlatWriter::symbol
+            (std::string_view const s) -> std::uint32_t
+        {
+            auto const [it, isNew] = symbolIndices_.try_emplace(std::string(s), static_cast<std::uint32_t>(symbols_.size()));
+            if (isNew)
+            {
+                symbols_.push_back(FlatSymbol {static_cast<std::uint32_t>(chars_.size()), static_cast<std::uint32_t>(s.size())});
+                chars_.append(s);
+            }
+            return it->second;
+        }
+
+        auto FlatWriter::name
+            (std::string_view const s) -> std::uint32_t
+        {
+            auto const index = this->add(FlatKind::Name, this->symbol(s));
+            this->finish(index, {});
+            return index;
+        }
+
+        template<class Node>
+        auto FlatWriter::node
+            (Node const* const n) -> std::uint32_t
+        {
+            if (not n)
+            {
+                return NoNode;
+            }
+            auto const index = static_cast<std::uint32_t>(nodes_.size());
+            nodes_.push_back(FlatNode {});
+            pending_.push_back(Pending {n, [](void const* const p, CodeVisitor& v)
+            {
+                static_cast<Node const*>(p)->accept(v);
+            }, index});
+            return index;
+        }
+
+        template<class Range>
+        auto FlatWriter::append
+            (indices_t& indices, Range const& nodes) -> void
+        {
+            for (auto const n : nodes)
+            {
+                indices.push_back(this->node(n));
+            }
+        }
+
+        template<class Range, class F>
+        auto FlatWriter::list
+            (Range const& ts, F&& write_one) -> std::uint32_t
+        {
+            auto const index = this->add(FlatKind::List);
+            auto items = indices_t();
+            items.reserve(ts.size());
+            for (auto const& t : ts)
+            {
+                items.push_back(write_one(t));
+            }
+            this->finish(index, items);
+            return index;
+        }
+
+        auto FlatWriter::compound
+            (CompoundStatement const& c) -> std::uint32_t
+        {
+            this->visit(c);
+            return last_;
+        }
+
+        auto FlatWriter::compound
+            (std::optional<CompoundStatement> const& c) -> std::uint32_t
+        {
+            return c ? this->compound(*c) : NoNode;
+        }
+
+        auto FlatWriter::params
+            (params_t const& ps) -> std::uint32_t
+        {
+            return this->list(ps, [this](auto const& p)
+            {
+                this->visit(p);
+                return last_;
+            });
+        }
+
+        auto FlatWriter::var
+            (FlatKind const kind, VarDefCommon const& v) -> void
+        {
+            auto const index = this->add(kind, this->symbol(v.name_));
+            this->finish(index, {this->node(v.type_), this->node(v.initializer_)});
+        }
+
+        auto FlatWriter::visit
+            (IntLiteral const& i) -> void
+        {
+            ints_.push_back(i.num_);
+            this->finish(this->add(FlatKind::IntLiteral, static_cast<std::uint32_t>(ints_.size() - 1)), {});
+        }
+
+        auto FlatWriter::visit
+            (FloatLiteral const& f) -> void
+        {
+            floats_.push_back(f.num_);
+            this->finish(this->add(FlatKind::FloatLiteral, static_cast<std::uint32_t>(floats_.size() - 1)), {});
+        }
+
+        auto FlatWriter::visit
+            (StringLiteral const& s) -> void
+        {
+            this->finish(this->add(FlatKind::StringLiteral, this->symbol(s.str_)), {});
+        }
+
+        auto FlatWriter::visit
+            (NullLiteral const&) -> void
+        {
+            this->finish(this->add(FlatKind::NullLiteral), {});
+        }
+
+        auto FlatWriter::visit
+            (BoolLiteral const& b) -> void
+        {
+            this->finish(this->add(FlatKind::BoolLiteral, 0, b.val_ ? TrueFlag : 0), {});
+        }
+
+        auto FlatWriter::visit
+            (BinaryOperator const& b) -> void
+        {
+            auto const index = this->add(FlatKind::BinaryOperator, 0, 0, static_cast<std::uint16_t>(b.op_));
+            this->finish(index, {this->node(b.lhs_), this->node(b.rhs_)});
+        }
+
+        auto FlatWriter::visit
+            (OperatorChain const& c) -> void
+        {
+            auto const index = this->add(FlatKind::OperatorChain, 0, 0, static_cast<std::uint16_t>(c.op_));
+            auto children = indices_t();
+            this->append(children, c.operands_);
+            this->finish(index, children);
+        }
+
+        auto FlatWriter::visit
+            (Parenthesis const& p) -> void
+        {
+            auto const index = this->add(FlatKind::Parenthesis);
+            this->finish(index, {this->node(p.expression_)});
+        }
+
+        auto FlatWriter::visit
+            (VarRef const& v) -> void
+        {
+            this->finish(this->add(FlatKind::VarRef, this->symbol(v.name_)), {});
+        }
+
+        auto FlatWriter::visit
+            (MemberVarRef const& m) -> void
+        {
+            auto const index = this->add(FlatKind::MemberVarRef, this->symbol(m.name_));
+            this->finish(index, {this->node(m.base_)});
+        }
+
+        auto FlatWriter::visit
+            (UnaryOperator const& u) -> void
+        {
+            auto const isType = std::holds_alternative<Type*>(u.arg_);
+            auto const index  = this->add( FlatKind::UnaryOperator
+                                         , 0
+                                         , isType ? TypeArgFlag : 0
+                                         , static_cast<std::uint16_t>(u.op_) );
+            auto const arg = std::visit([this](auto const a)
+            {
+                return this->node(a);
+            }, u.arg_);
+            this->finish(index, {arg});
+        }
+
+        auto FlatWriter::visit
+            (New const& n) -> void
+        {
+            auto const index = this->add(FlatKind::New);
+            auto children = indices_t {this->node(n.type_)};
+            this->append(children, n.args_);
+            this->finish(index, children);
+        }
+
+        auto FlatWriter::visit
+            (FunctionCall const& f) -> void
+        {
+            auto const index = this->add(FlatKind::FunctionCall, this->symbol(f.name_));
+            auto children = indices_t();
+            this->append(children, f.args_);
+            this->finish(index, children);
+        }
+
+        auto FlatWriter::visit
+            (ConstructorCall const& c) -> void
+        {
+            auto const index = this->add(FlatKind::ConstructorCall);
+            auto children = indices_t {this->node(c.type_)};
+            this->append(children, c.args_);
+            this->finish(index, children);
+        }
+
+        auto FlatWriter::visit
+            (DestructorCall const& d) -> void
+        {
+            auto const index = this->add(FlatKind::DestructorCall);
+            this->finish(index, {this->node(d.ex_)});
+        }
+
+        auto FlatWriter::visit
+            (MemberFunctionCall const& m) -> void
+        {
+            auto const index = this->add(FlatKind::MemberFunctionCall, this->symbol(m.call_));
+            auto children = indices_t {this->node(m.base_)};
+            this->append(children, m.args_);
+            this->finish(index, children);
+        }
+
+        auto FlatWriter::visit
+            (ExpressionCall const& e) -> void
+        {
+            auto const index = this->add(FlatKind::ExpressionCall);
+            auto children = indices_t {this->node(e.ex_)};
+            this->append(children, e.args_);
+            this->finish(index, children);
+        }
+
+        auto FlatWriter::visit
+            (This const&) -> void
+        {
+            this->finish(this->add(FlatKind::This), {});
+        }
+
+        auto FlatWriter::visit
+            (IfExpression const& i) -> void
+        {
+            auto const index = this->add(FlatKind::IfExpression);
+            this->finish(index, {this->node(i.cond_), this->node(i.then_), this->node(i.else_)});
+        }
+
+        auto FlatWriter::visit
+            (Lambda const& l) -> void
+        {
+            auto const index = this->add(FlatKind::Lambda);
+            this->finish(index, {this->params(l.params_), this->compound(l.body_)});
+        }
+
+        auto FlatWriter::visit
+            (PrimType const& p) -> void
+        {
+            auto const flags = type_flags(p);
+            this->finish(this->add(FlatKind::PrimType, this->symbol(p.name_), flags), {});
+        }
+
+        auto FlatWriter::visit
+            (CustomType const& c) -> void
+        {
+            auto const flags = type_flags(c);
+            this->finish(this->add(FlatKind::CustomType, this->symbol(c.name_), flags), {});
+        }
+
+        auto FlatWriter::visit
+            (TemplatedType const& t) -> void
+        {
+            auto const flags = type_flags(t);
+            auto const index = this->add(FlatKind::TemplatedType, 0, flags);
+            auto children = indices_t {this->node(t.base_)};
+            for (auto const& arg : t.args_)
+            {
+                children.push_back(std::visit([this](auto const a)
+                {
+                    return this->node(a);
+                }, arg));
+            }
+            this->finish(index, children);
+        }
+
+        auto FlatWriter::visit
+            (Indirection const& i) -> void
+        {
+            auto const flags = type_flags(i);
+            auto const index = this->add(FlatKind::Indirection, 0, flags);
+            this->finish(index, {this->node(i.pointee_)});
+        }
+
+        auto FlatWriter::visit
+            (Function const& f) -> void
+        {
+            auto const index = this->add(FlatKind::Function, 0, type_flags(f));
+            auto children = indices_t {this->node(f.ret_)};
+            this->append(children, f.params_);
+            this->finish(index, children);
+        }
+
+        auto FlatWriter::visit
+            (Nested const& n) -> void
+        {
+            auto const flags = type_flags(n);
+            auto const index = this->add(FlatKind::Nested, this->symbol(n.name_), flags);
+            this->finish(index, {this->node(n.nest_)});
+        }
+
+        auto FlatWriter::visit
+            (Class const& c) -> void
+        {
+            auto const flags    = c.isInterface_ ? InterfaceFlag : std::uint8_t {0};
+            auto const index    = this->add(FlatKind::Class, this->symbol(c.qualName_), flags);
+            auto const name     = this->name(c.name_);
+            auto const alias    = c.alias_ ? this->name(*c.alias_) : NoNode;
+            auto const params   = this->list(c.templateParams_, [this](auto const& p)
+            {
+                return this->name(p);
+            });
+            auto const cons     = this->list(c.constructors_, [this](auto const& con)
+            {
+                auto const conIndex = this->add(FlatKind::Constructor);
+                auto const ps       = this->params(con.params_);
+                auto const bases    = this->list(con.baseInitList_, [this](auto const& b)
+                {
+                    auto const baseIndex = this->add(FlatKind::BaseInit);
+                    auto children = indices_t {this->node(b.base_)};
+                    this->append(children, b.init_);
+                    this->finish(baseIndex, children);
+                    return baseIndex;
+                });
+                auto const members  = this->list(con.initList_, [this](auto const& i)
+                {
+                    auto const memberIndex = this->add(FlatKind::MemberInit, this->symbol(i.name_));
+                    auto children = indices_t();
+                    this->append(children, i.init_);
+                    this->finish(memberIndex, children);
+                    return memberIndex;
+                });
+                auto const body     = this->compound(con.body_);
+                this->finish(conIndex, {ps, bases, members, body});
+                return conIndex;
+            });
+            auto const des      = [this, &c]()
+            {
+                if (not c.destructor_)
+                {
+                    return NoNode;
+                }
+                auto const desIndex = this->add(FlatKind::Destructor);
+                this->finish(desIndex, {this->compound(c.destructor_->body_)});
+                return desIndex;
+            }();
+            auto const methods  = this->list(c.methods_, [this](auto const& m)
+            {
+                this->visit(m);
+                return last_;
+            });
+            auto const fields   = this->list(c.fields_, [this](auto const& f)
+            {
+                this->visit(f);
+                return last_;
+            });
+            auto const bases    = this->list(c.bases_, [this](auto const b)
+            {
+                return this->node(b);
+            });
+            auto const typedefs = this->list(c.typedefs_, [this](auto const& t)
+            {
+                auto const aliasIndex = this->add(FlatKind::Alias, this->symbol(t.alias_));
+                this->finish(aliasIndex, {this->node(t.type_)});
+                return aliasIndex;
+            });
+            this->finish(index, {name, alias, params, cons, des, methods, fields, bases, typedefs});
+        }
+
+        auto FlatWriter::visit
+            (Method const& m) -> void
+        {
+            auto const index = this->add(FlatKind::Method, this->symbol(m.name_));
+            this->finish(index, {this->node(m.retType_), this->params(m.params_), this->compound(m.body_)});
+        }
+
+        auto FlatWriter::visit
+            (VarDefCommon const& v) -> void
+        {
+            this->var(FlatKind::VarDefinition, v);
+        }
+
+        auto FlatWriter::visit
+            (FieldDefinition const& f) -> void
+        {
+            this->var(FlatKind::Field, f.var_);
+        }
+
+        auto FlatWriter::visit
+            (ParamDefinition const& p) -> void
+        {
+            this->var(FlatKind::Param, p.var_);
+        }
+
+        auto FlatWriter::visit
+            (VarDefinition const& v) -> void
+        {
+            this->var(FlatKind::VarDefinition, v.var_);
+        }
+
+        auto FlatWriter::visit
+            (ForLoop const& f) -> void
+        {
+            auto const index = this->add(FlatKind::ForLoop);
+            this->finish(index, {this->node(f.var_), this->node(f.cond_), this->node(f.inc_), this->compound(f.body_)});
+        }
+
+        auto FlatWriter::visit
+            (WhileLoop const& w) -> void
+        {
+            auto const index = this->add(FlatKind::WhileLoop);
+            this->finish(index, {this->node(w.loop_.condition_), this->compound(w.loop_.body_)});
+        }
+
+        auto FlatWriter::visit
+            (DoWhileLoop const& d) -> void
+        {
+            auto const index = this->add(FlatKind::DoWhileLoop);
+            this->finish(index, {this->node(d.loop_.condition_), this->compound(d.loop_.body_)});
+        }
+
+        auto FlatWriter::visit
+            (CompoundStatement const& c) -> void
+        {
+            auto const index = this->add(FlatKind::CompoundStatement);
+            auto children = indices_t();
+            this->append(children, c.statements_);
+            this->finish(index, children);
+        }
+
+        auto FlatWriter::visit
+            (ExpressionStatement const& e) -> void
+        {
+            auto const index = this->add(FlatKind::ExpressionStatement);
+            this->finish(index, {this->node(e.expression_)});
+        }
+
+        auto FlatWriter::visit
+            (Return const& r) -> void
+        {
+            auto const index = this->add(FlatKind::Return);
+            this->finish(index, {this->node(r.expression_)});
+        }
+
+        auto FlatWriter::visit
+            (If const& i) -> void
+        {
+            auto const index = this->add(FlatKind::If);
+            this->finish(index, {this->node(i.condition_), this->compound(i.then_), this->compound(i.else_)});
+        }
+
+        auto FlatWriter::visit
+            (Delete const& d) -> void
+        {
+            auto const index = this->add(FlatKind::Delete);
+            this->finish(index, {this->node(d.ex_)});
+        }
+
+        auto FlatWriter::visit
+            (Throw const&) -> void
+        {
+            this->finish(this->add(FlatKind::Throw), {});
+        }
+
+        auto FlatWriter::visit
+            (Break const&) -> void
+        {
+            this->finish(this->add(FlatKind::Break), {});
+        }
+
+        auto FlatWriter::visit
+            (Case const& c) -> void
+        {
+            auto const index = this->add(FlatKind::Case);
+            this->finish(index, {this->node(c.expr_), this->compound(c.body_)});
+        }
+
+        auto FlatWriter::visit
+            (Switch const& s) -> void
+        {
+            auto const index = this->add(FlatKind::Switch);
+            auto children = indices_t {this->node(s.cond_), this->compound(s.default_)};
+            for (auto const& c : s.cases_)
+            {
+                this->visit(c);
+                children.push_back(last_);
+            }
+            this->finish(index, children);
+        }
+
+// FlatReader definitions:
+
+        FlatReader::FlatReader
+            (FlatView const& view) :
+            view_        (&view),
+            arena_       (std::make_unique<Arena>()),
+            types_       (*arena_),
+            symbols_     (),
+            expressions_ (),
+            typeNodes_   (),
+            statements_  (),
+            valid_       (true)
+        {
+        }
+
+        auto FlatReader::read_unit
+            () -> std::optional<TranslationUnit>
+        {
+            symbols_.reserve(view_->symbol_count());
+            for (auto i = 0u; i < view_->symbol_count(); ++i)
+            {
+                symbols_.push_back(arena_->intern(view_->symbol(i)));
+            }
+
+            if (view_->node_count() == 0 or view_->node(0).kind_ != FlatKind::List)
+            {
+                return std::nullopt;
+            }
+
+            this->build_nodes();
+            auto classes = std::vector<Class*>();
+            auto const root = this->fetch(0);
+            for (auto k = 0u; k < root.count_ and valid_; ++k)
+            {
+                auto const c = this->read_class(this->child(0, root, k));
+                if (c)
+                {
+                    classes.push_back(c);
+                }
+            }
+
+            if (not valid_)
+            {
+                return std::nullopt;
+            }
+            return TranslationUnit(std::move(arena_), std::move(classes));
+        }
+
+        auto FlatReader::fetch
+            (std::uint32_t const index) -> FlatNode
+        {
+            auto constexpr Empty = FlatNode {FlatKind::List, 0, 0, 0, 0, 0};
+            if (index >= view_->node_count())
+            {
+                this->fail();
+                return Empty;
+            }
+
+            auto const n = view_->node(index);
+            auto const end = std::uint64_t {n.first_} + n.count_;
+            if (end > view_->child_count() or n.kind_ > FlatKind::List)
+            {
+                this->fail();
+                return Empty;
+            }
+            return n;
+        }
+
+        auto FlatReader::child
+            (std::uint32_t const parent, FlatNode const& n, std::uint32_t const k) -> std::uint32_t
+        {
+            if (k >= n.count_)
+            {
+                this->fail();
+                return NoNode;
+            }
+
+            auto const index = view_->child(n.first_ + k);
+            if (index != NoNode and (index <= parent or index >= view_->node_count()))
+            {
+                this->fail();
+                return NoNode;
+            }
+            return index;
+        }
+
+        auto FlatReader::symbol
+            (FlatNode const& n) -> Symbol
+        {
+            if (n.value_ >= symbols_.size())
+            {
+                this->fail();
+                return Symbol();
+            }
+            return symbols_[n.value_];
+        }
+
+        auto FlatReader::opcode
+            (FlatNode const& n, std::uint16_t const max) -> std::uint16_t
+        {
+            if (n.op_ > max)
+            {
+                this->fail();
+                return max;
+            }
+            return n.op_;
+        }
+
+        auto FlatReader::read_expressions
+            (std::uint32_t const index, FlatNode const& n, std::uint32_t const from) -> args_t
+        {
+            auto es = args_t();
+            for (auto k = from; k < n.count_ and valid_; ++k)
+            {
+                es.push_back(this->read_expression(this->child(index, n, k)));
+            }
+            return es;
+        }
+
+        auto FlatReader::read_types
+            (std::uint32_t const index, FlatNode const& n, std::uint32_t const from) -> std::vector<Type*>
+        {
+            auto ts = std::vector<Type*>();
+            for (auto k = from; k < n.count_ and valid_; ++k)
+            {
+                ts.push_back(this->read_type(this->child(index, n, k)));
+            }
+            return ts;
+        }
+
+        template<class T, class Seq, class F>
+        auto FlatReader::read_list
+            (std::uint32_t const index, F&& read_one) -> Seq
+        {
+            auto ts = Seq();
+            auto const n = this->fetch(index);
+            if (not valid_ or n.kind_ != FlatKind::List)
+            {
+                this->fail();
+                return ts;
+            }
+
+            ts.reserve(n.count_);
+            for (auto k = 0u; k < n.count_ and valid_; ++k)
+            {
+                ts.emplace_back(read_one(this->child(index, n, k)));
+            }
+            return ts;
+        }
+
+        auto FlatReader::build_nodes
+            () -> void
+        {
+            auto const count = view_->node_count();
+            expressions_.resize(count, nullptr);
+            typeNodes_.resize(count, nullptr);
+            statements_.resize(count, nullptr);
+
+            // Compound statements and cases are mostly parts of other nodes,
+            // only those in a place of a statement are built as statements.
+            auto isStatement = std::vector<std::uint8_t>(count, false);
+            for (auto i = 0u; i < count and valid_; ++i)
+            {
+                auto const n = this->fetch(i);
+                if (n.kind_ == FlatKind::CompoundStatement or (n.kind_ == FlatKind::ForLoop and n.count_ > 0))
+                {
+                    auto const last = n.kind_ == FlatKind::ForLoop ? 1u : n.count_;
+                    for (auto k = 0u; k < last and valid_; ++k)
+                    {
+                        auto const c = this->child(i, n, k);
+                        if (c != NoNode)
+                        {
+                            isStatement[c] = true;
+                        }
+                    }
+                }
+            }
+
+            for (auto i = count; i > 0 and valid_; --i)
+            {
+                auto const index = i - 1;
+                auto const kind  = this->fetch(index).kind_;
+                if (kind < FlatKind::PrimType)
+                {
+                    expressions_[index] = this->build_expression(index);
+                }
+                else if (kind < FlatKind::Delete)
+                {
+                    // Types are classified when written, not again.
+                    auto const type = this->build_type(index);
+                    if (type)
+                    {
+                        type->isInterface_ = (this->fetch(index).flags_ & InterfaceFlag) != 0;
+                    }
+                    typeNodes_[index] = type;
+                }
+                else if (kind < FlatKind::Class)
+                {
+                    auto const isPart = kind == FlatKind::CompoundStatement or kind == FlatKind::Case;
+                    if (not isPart or isStatement[index])
+                    {
+                        statements_[index] = this->build_statement(index);
+                    }
+                }
+            }
+        }
+
+        auto FlatReader::read_expression
+            (std::uint32_t const index) -> Expression*
+        {
+            if (index == NoNode or not valid_)
+            {
+                return nullptr;
+            }
+            if (not expressions_[index])
+            {
+                this->fail();
+            }
+            return expressions_[index];
+        }
+
+        auto FlatReader::read_type
+            (std::uint32_t const index) -> Type*
+        {
+            if (index == NoNode or not valid_)
+            {
+                return nullptr;
+            }
+            if (not typeNodes_[index])
+            {
+                this->fail();
+            }
+            return typeNodes_[index];
+        }
+
+        auto FlatReader::read_statement
+            (std::uint32_t const index) -> Statement*
+        {
+            if (index == NoNode or not valid_)
+            {
+                return nullptr;
+            }
+            if (not statements_[index])
+            {
+                this->fail();
+            }
+            return statements_[index];
+        }
+
+        auto FlatReader::build_expression
+            (std::uint32_t const index) -> Expression*
+        {
+            // Arguments are read into variables first since
+            // the order of evaluation of function arguments is unspecified.
+            auto const n   = this->fetch(index);
+            auto const kid = [this, index, &n](std::uint32_t const k)
+            {
+                return this->child(index, n, k);
+            };
+            switch (n.kind_)
+            {
+                case FlatKind::IntLiteral:
+                    if (n.value_ >= view_->int_count())
+                    {
+                        this->fail();
+                        return nullptr;
+                    }
+                    return arena_->make<IntLiteral>(view_->integer(n.value_));
+
+                case FlatKind::FloatLiteral:
+                    if (n.value_ >= view_->float_count())
+                    {
+                        this->fail();
+                        return nullptr;
+                    }
+                    return arena_->make<FloatLiteral>(view_->floating(n.value_));
+
+                case FlatKind::StringLiteral:
+                    return arena_->make<StringLiteral>(this->symbol(n));
+
+                case FlatKind::NullLiteral:
+                    return arena_->make<NullLiteral>();
+
+                case FlatKind::BoolLiteral:
+                    return arena_->make<BoolLiteral>((n.flags_ & TrueFlag) != 0);
+
+                case FlatKind::BinaryOperator:
+                {
+                    auto const op = static_cast<BinOpcode>(this->opcode(n, static_cast<std::uint16_t>(BinOpcode::Unknown)));
+                    auto lhs = this->read_expression(kid(0));
+                    auto rhs = this->read_expression(kid(1));
+                    return arena_->make<BinaryOperator>(lhs, op, rhs);
+                }
+
+                case FlatKind::OperatorChain:
+                {
+                    auto const op = static_cast<BinOpcode>(this->opcode(n, static_cast<std::uint16_t>(BinOpcode::Unknown)));
+                    if (n.count_ < 3 or not is_associative(op))
+                    {
+                        this->fail();
+                        return nullptr;
+                    }
+                    return arena_->make<OperatorChain>(op, this->read_expressions(index, n, 0));
+                }
+
+                case FlatKind::UnaryOperator:
+                {
+                    auto const op = static_cast<UnOpcode>(this->opcode(n, static_cast<std::uint16_t>(UnOpcode::Unknown)));
+                    return (n.flags_ & TypeArgFlag) != 0
+                        ? arena_->make<UnaryOperator>(op, this->read_type(kid(0)))
+                        : arena_->make<UnaryOperator>(op, this->read_expression(kid(0)));
+                }
+
+                case FlatKind::Parenthesis:
+                    return arena_->make<Parenthesis>(this->read_expression(kid(0)));
+
+                case FlatKind::VarRef:
+                    return arena_->make<VarRef>(this->symbol(n));
+
+                case FlatKind::MemberVarRef:
+                {
+                    auto base = this->read_expression(kid(0));
+                    return arena_->make<MemberVarRef>(base, this->symbol(n));
+                }
+
+                case FlatKind::New:
+                {
+                    auto type = this->read_type(kid(0));
+                    auto args = this->read_expressions(index, n, 1);
+                    return arena_->make<New>(type, std::move(args));
+                }
+
+                case FlatKind::FunctionCall:
+                    return arena_->make<FunctionCall>(this->symbol(n), this->read_expressions(index, n, 0));
+
+                case FlatKind::ConstructorCall:
+                {
+                    auto type = this->read_type(kid(0));
+                    auto args = this->read_expressions(index, n, 1);
+                    return arena_->make<ConstructorCall>(type, std::move(args));
+                }
+
+                case FlatKind::DestructorCall:
+                    return arena_->make<DestructorCall>(this->read_expression(kid(0)));
+
+                case FlatKind::MemberFunctionCall:
+                {
+                    auto base = this->read_expression(kid(0));
+                    auto args = this->read_expressions(index, n, 1);
+                    return arena_->make<MemberFunctionCall>(base, this->symbol(n), std::move(args));
+                }
+
+                case FlatKind::ExpressionCall:
+                {
+                    auto ex   = this->read_expression(kid(0));
+                    auto args = this->read_expressions(index, n, 1);
+                    return arena_->make<ExpressionCall>(ex, std::move(args));
+                }
+
+                case FlatKind::This:
+                    return arena_->make<This>();
+
+                case FlatKind::IfExpression:
+                {
+                    auto cond = this->read_expression(kid(0));
+                    auto then = this->read_expression(kid(1));
+                    auto els  = this->read_expression(kid(2));
+                    return arena_->make<IfExpression>(cond, then, els);
+                }
+
+                case FlatKind::Lambda:
+                {
+                    auto params = this->read_params(kid(0));
+                    auto body   = this->read_compound(kid(1));
+                    return arena_->make<Lambda>(std::move(params), std::move(body));
+                }
+
+                default:
+                    this->fail();
+                    return nullptr;
+            }
+        }
+
+        auto FlatReader::build_type
+            (std::uint32_t const index) -> Type*
+        {
+            auto const n       = this->fetch(index);
+            auto const isConst = IsConst((n.flags_ & IsConstFlag) != 0);
+            switch (n.kind_)
+            {
+                case FlatKind::PrimType:
+                    return types_.prim_type(isConst, this->symbol(n));
+
+                case FlatKind::CustomType:
+                    return types_.custom_type(isConst, this->symbol(n));
+
+                case FlatKind::TemplatedType:
+                {
+                    auto base = this->read_type(this->child(index, n, 0));
+                    auto args = std::vector<TemplatedType::arg_var_t>();
+                    for (auto k = 1u; k < n.count_ and valid_; ++k)
+                    {
+                        // Kind of the argument tells which alternative it is.
+                        auto const arg = this->child(index, n, k);
+                        auto const isExpression = arg != NoNode and this->fetch(arg).kind_ < FlatKind::PrimType;
+                        args.push_back(isExpression
+                            ? TemplatedType::arg_var_t(this->read_expression(arg))
+                            : TemplatedType::arg_var_t(this->read_type(arg)));
+                    }
+                    return types_.templated_type(isConst, base, std::move(args));
+                }
+
+                case FlatKind::Indirection:
+                    return types_.indirection(isConst, this->read_type(this->child(index, n, 0)));
+
+                case FlatKind::Function:
+                {
+                    auto ret    = this->read_type(this->child(index, n, 0));
+                    auto params = this->read_types(index, n, 1);
+                    return types_.function(std::move(params), ret);
+                }
+
+                case FlatKind::Nested:
+                {
+                    auto nest = this->read_type(this->child(index, n, 0));
+                    return types_.nested(isConst, nest, this->symbol(n));
+                }
+
+                default:
+                    this->fail();
+                    return nullptr;
+            }
+        }
+
+        auto FlatReader::build_statement
+            (std::uint32_t const index) -> Statement*
+        {
+            auto const n   = this->fetch(index);
+            auto const kid = [this, index, &n](std::uint32_t const k)
+            {
+                return this->child(index, n, k);
+            };
+            switch (n.kind_)
+            {
+                case FlatKind::Delete:
+                    return arena_->make<Delete>(this->read_expression(kid(0)));
+
+                case FlatKind::VarDefinition:
+                {
+                    auto var = this->read_var(index, FlatKind::VarDefinition);
+                    return arena_->make<VarDefinition>(var.type_, var.name_, var.initializer_);
+                }
+
+                case FlatKind::CompoundStatement:
+                    return arena_->make<CompoundStatement>(this->read_compound(index));
+
+                case FlatKind::Return:
+                    return arena_->make<Return>(this->read_expression(kid(0)));
+
+                case FlatKind::If:
+                {
+                    auto cond = this->read_expression(kid(0));
+                    auto then = this->read_compound(kid(1));
+                    auto els  = this->read_optional_compound(kid(2));
+                    return els
+                        ? arena_->make<If>(cond, std::move(then), std::move(*els))
+                        : arena_->make<If>(cond, std::move(then));
+                }
+
+                case FlatKind::ExpressionStatement:
+                    return arena_->make<ExpressionStatement>(this->read_expression(kid(0)));
+
+                case FlatKind::ForLoop:
+                {
+                    auto var  = this->read_statement(kid(0));
+                    auto cond = this->read_expression(kid(1));
+                    auto inc  = this->read_expression(kid(2));
+                    auto body = this->read_compound(kid(3));
+                    return arena_->make<ForLoop>(var, cond, inc, std::move(body));
+                }
+
+                case FlatKind::WhileLoop:
+                {
+                    auto cond = this->read_expression(kid(0));
+                    auto body = this->read_compound(kid(1));
+                    return arena_->make<WhileLoop>(cond, std::move(body));
+                }
+
+                case FlatKind::DoWhileLoop:
+                {
+                    auto cond = this->read_expression(kid(0));
+                    auto body = this->read_compound(kid(1));
+                    return arena_->make<DoWhileLoop>(cond, std::move(body));
+                }
+
+                case FlatKind::Break:
+                    return arena_->make<Break>();
+
+                case FlatKind::Case:
+                    return arena_->make<Case>(this->read_case(index));
+
+                case FlatKind::Switch:
+                {
+                    auto cond  = this->read_expression(kid(0));
+                    auto def   = this->read_optional_compound(kid(1));
+                    auto cases = std::vector<Case>();
+                    for (auto k = 2u; k < n.count_ and valid_; ++k)
+                    {
+                        cases.push_back(this->read_case(kid(k)));
+                    }
+                    return def
+                        ? arena_->make<Switch>(cond, std::move(cases), std::move(*def))
+                        : arena_->make<Switch>(cond, std::move(cases));
+                }
+
+                case FlatKind::Throw:
+                    return arena_->make<Throw>();
+
+                default:
+                    this->fail();
+                    return nullptr;
+            }
+        }
+
+        auto FlatReader::read_compound
+            (std::uint32_t const index) -> CompoundStatement
+        {
+            auto statements = std::vector<Statement*>();
+            auto const n = this->fetch(index);
+            if (n.kind_ != FlatKind::CompoundStatement)
+            {
+                this->fail();
+                return CompoundStatement(std::move(statements));
+            }
+
+            statements.reserve(n.count_);
+            for (auto k = 0u; k < n.count_ and valid_; ++k)
+            {
+                statements.push_back(this->read_statement(this->child(index, n, k)));
+            }
+            return CompoundStatement(std::move(statements));
+        }
+
+        auto FlatReader::read_optional_compound
+            (std::uint32_t const index) -> std::optional<CompoundStatement>
+        {
+            return index == NoNode
+                ? std::nullopt
+                : std::optional<CompoundStatement>(this->read_compound(index));
+        }
+
+        auto FlatReader::read_var
+            (std::uint32_t const index, FlatKind const kind) -> VarDefCommon
+        {
+            auto const n = this->fetch(index);
+            if (n.kind_ != kind)
+            {
+                this->fail();
+                return VarDefCommon(nullptr, Symbol());
+            }
+            auto type = this->read_type(this->child(index, n, 0));
+            auto init = this->read_expression(this->child(index, n, 1));
+            return VarDefCommon(type, this->symbol(n), init);
+        }
+
+        auto FlatReader::read_params
+            (std::uint32_t const index) -> params_t
+        {
+            return this->read_list<ParamDefinition, params_t>(index, [this](std::uint32_t const p)
+            {
+                auto var = this->read_var(p, FlatKind::Param);
+                return ParamDefinition(var.type_, var.name_, var.initializer_);
+            });
+        }
+
+        auto FlatReader::read_case
+            (std::uint32_t const index) -> Case
+        {
+            auto const n = this->fetch(index);
+            if (n.kind_ != FlatKind::Case)
+            {
+                this->fail();
+                return Case(nullptr, CompoundStatement(std::vector<Statement*>()));
+            }
+            auto expr = this->read_expression(this->child(index, n, 0));
+            auto body = this->read_compound(this->child(index, n, 1));
+            return Case(expr, std::move(body));
+        }
+
+        auto FlatReader::read_method
+            (std::uint32_t const index) -> Method
+        {
+            auto const n = this->fetch(index);
+            if (n.kind_ != FlatKind::Method)
+            {
+                this->fail();
+                return Method(Symbol(), nullptr, {}, std::nullopt);
+            }
+            auto ret    = this->read_type(this->child(index, n, 0));
+            auto params = this->read_params(this->child(index, n, 1));
+            auto body   = this->read_optional_compound(this->child(index, n, 2));
+            return Method(this->symbol(n), ret, std::move(params), std::move(body));
+        }
+
+        auto FlatReader::read_constructor
+            (std::uint32_t const index) -> Constructor
+        {
+            auto const n = this->fetch(index);
+            if (n.kind_ != FlatKind::Constructor)
+            {
+                this->fail();
+                return Constructor({}, {}, {}, std::nullopt);
+            }
+
+            auto params = this->read_params(this->child(index, n, 0));
+            auto bases  = this->read_list<BaseInitPair>(this->child(index, n, 1), [this](std::uint32_t const b)
+            {
+                auto const bn = this->fetch(b);
+                if (bn.kind_ != FlatKind::BaseInit)
+                {
+                    this->fail();
+                    return BaseInitPair(nullptr, {});
+                }
+                auto base = this->read_type(this->child(b, bn, 0));
+                return BaseInitPair(base, this->read_expressions(b, bn, 1));
+            });
+            auto members = this->read_list<MemberInitPair>(this->child(index, n, 2), [this](std::uint32_t const m)
+            {
+                auto const mn = this->fetch(m);
+                if (mn.kind_ != FlatKind::MemberInit)
+                {
+                    this->fail();
+                    return MemberInitPair(Symbol(), {});
+                }
+                return MemberInitPair(this->symbol(mn), this->read_expressions(m, mn, 0));
+            });
+            auto body = this->read_optional_compound(this->child(index, n, 3));
+            return Constructor(std::move(params), std::move(bases), std::move(members), std::move(body));
+        }
+
+        auto FlatReader::read_name
+            (std::uint32_t const index) -> std::string
+        {
+            auto const n = this->fetch(index);
+            if (n.kind_ != FlatKind::Name)
+            {
+                this->fail();
+                return std::string();
+            }
+            return this->symbol(n).str();
+        }
+
+        auto FlatReader::read_class
+            (std::uint32_t const index) -> Class*
+        {
+            auto const n = this->fetch(index);
+            if (n.kind_ != FlatKind::Class)
+            {
+                this->fail();
+                return nullptr;
+            }
+
+            auto const kid = [this, index, &n](std::uint32_t const k)
+            {
+                return this->child(index, n, k);
+            };
+            auto c = arena_->make<Class>(this->symbol(n).str());
+            c->isInterface_ = (n.flags_ & InterfaceFlag) != 0;
+            c->name_ = this->read_name(kid(0));
+            if (auto const alias = kid(1); alias != NoNode)
+            {
+                c->alias_ = this->read_name(alias);
+            }
+            c->templateParams_ = this->read_list<std::string>(kid(2), [this](std::uint32_t const p)
+            {
+                return this->read_name(p);
+            });
+            c->constructors_ = this->read_list<Constructor>(kid(3), [this](std::uint32_t const con)
+            {
+                return this->read_constructor(con);
+            });
+            if (auto const des = kid(4); des != NoNode)
+            {
+                auto const dn = this->fetch(des);
+                if (dn.kind_ != FlatKind::Destructor)
+                {
+                    this->fail();
+                    return nullptr;
+                }
+                c->destructor_ = Destructor(this->read_optional_compound(this->child(des, dn, 0)));
+            }
+            c->methods_ = this->read_list<Method>(kid(5), [this](std::uint32_t const m)
+            {
+                return this->read_method(m);
+            });
+            c->fields_ = this->read_list<FieldDefinition>(kid(6), [this](std::uint32_t const f)
+            {
+                auto var = this->read_var(f, FlatKind::Field);
+                return FieldDefinition(var.type_, var.name_, var.initializer_);
+            });
+            c->bases_ = this->read_list<Type*>(kid(7), [this](std::uint32_t const b)
+            {
+                return this->read_type(b);
+            });
+            c->typedefs_ = this->read_list<AliasDecl>(kid(8), [this](std::uint32_t const t)
+            {
+                auto const tn = this->fetch(t);
+                if (tn.kind_ != FlatKind::Alias)
+                {
+                    this->fail();
+                    return AliasDecl(nullptr, Symbol());
+                }
+                return AliasDecl(this->read_type(this->child(t, tn, 0)), this->symbol(tn));
+            });
+            return c;
+        }
+
+        auto FlatReader::fail
+            () -> void
+        {
+            valid_ = false;
+        }
+
+// FlatView definitions:
+
+        FlatView::FlatView
+            (std::string_view const image, FlatHeader const& header) :
+            image_    (image),
+            header_   (header),
+            floats_   (sizeof(FlatHeader) + header.nodes_ * sizeof(FlatNode)),
+            ints_     (floats_ + header.floats_ * sizeof(double)),
+            children_ (ints_ + header.ints_ * sizeof(std::int64_t)),
+            symbols_  (children_ + header.children_ * sizeof(std::uint32_t)),
+            chars_    (symbols_ + header.symbols_ * sizeof(FlatSymbol))
+        {
+        }
+
+        auto FlatView::map
+            (std::string_view const image) -> std::optional<FlatView>
+        {
+            auto header = FlatHeader {};
+            if (image.size() < sizeof(FlatHeader))
+            {
+                return std::nullopt;
+            }
+            std::memcpy(&header, image.data(), sizeof(FlatHeader));
+            if (header.magic_ != Magic)
+            {
+                return std::nullopt;
+            }
+
+            // Sizes are computed in 64 bits, so that they do not overflow.
+            auto const size = std::uint64_t {sizeof(FlatHeader)}
+                            + std::uint64_t {header.nodes_}    * sizeof(FlatNode)
+                            + std::uint64_t {header.floats_}   * sizeof(double)
+                            + std::uint64_t {header.ints_}     * sizeof(std::int64_t)
+                            + std::uint64_t {header.children_} * sizeof(std::uint32_t)
+                            + std::uint64_t {header.symbols_}  * sizeof(FlatSymbol)
+                            + std::uint64_t {header.chars_};
+            if (size != image.size())
+            {
+                return std::nullopt;
+            }
+
+            auto const view = FlatView(image, header);
+            for (auto i = 0u; i < header.symbols_; ++i)
+            {
+                auto const s = view.read<FlatSymbol>(view.symbols_ + i * sizeof(FlatSymbol));
+                if (std::uint64_t {s.offset_} + s.size_ > header.chars_)
+                {
+                    return std::nullopt;
+                }
+            }
+            return view;
+        }
+
+        auto FlatView::node_count
+            () const -> std::uint32_t
+        {
+            return header_.nodes_;
+        }
+
+        auto FlatView::child_count
+            () const -> std::uint32_t
+        {
+            return header_.children_;
+        }
+
+        auto FlatView::symbol_count
+            () const -> std::uint32_t
+        {
+            return header_.symbols_;
+        }
+
+        auto FlatView::int_count
+            () const -> std::uint32_t
+        {
+            return header_.ints_;
+        }
+
+        auto FlatView::float_count
+            () const -> std::uint32_t
+        {
+            return header_.floats_;
+        }
+
+        auto FlatView::node
+            (std::uint32_t const i) const -> FlatNode
+        {
+            return this->read<FlatNode>(sizeof(FlatHeader) + i * sizeof(FlatNode));
+        }
+
+        auto FlatView::child
+            (std::uint32_t const i) const -> std::uint32_t
+        {
+            return this->read<std::uint32_t>(children_ + i * sizeof(std::uint32_t));
+        }
+
+        auto FlatView::symbol
+            (std::uint32_t const i) const -> std::string_view
+        {
+            auto const s = this->read<FlatSymbol>(symbols_ + i * sizeof(FlatSymbol));
+            return image_.substr(chars_ + s.offset_, s.size_);
+        }
+
+        auto FlatView::integer
+            (std::uint32_t const i) const -> std::int64_t
+        {
+            return this->read<std::int64_t>(ints_ + i * sizeof(std::int64_t));
+        }
+
+        auto FlatView::floating
+            (std::uint32_t const i) const -> double
+        {
+            return this->read<double>(floats_ + i * sizeof(double));
+        }
+
+        template<class T>
+        auto FlatView::read
+            (std::size_t const offset) const -> T
+        {
+            // Image may be mapped at any address, elements are copied out.
+            auto t = T {};
+            std::memcpy(&t, image_.data() + offset, sizeof(T));
+            return t;
+        }
+    }
+
+// flatten and expand definitions:
+
+    auto flatten
+        (TranslationUnit const& unit) -> std::string
+    {
+        auto writer = FlatWriter();
+        writer.write_unit(unit);
+        return writer.image();
+    }
+
+    auto expand
+        (std::string_view const image) -> std::optional<TranslationUnit>
+    {
+        auto const view = FlatView::map(image);
+        if (not view)
+        {
+            return std::nullopt;
+        }
+        return FlatReader(*view).read_unit();
+    }
+}
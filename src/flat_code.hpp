@@ -0,0 +1,32 @@
+#ifndef FRI_FLAT_CODE_HPP
+#define FRI_FLAT_CODE_HPP
+
+#include "abstract_code.hpp"
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace fri
+{
+    /**
+     *  @brief Writes @p unit as a flat image, the storage format
+     *  of @c UnitCache .
+     *
+     *  The image is a header followed by arrays of nodes, floats, integers,
+     *  children, symbols and characters. Nodes refer to each other by 32-bit
+     *  indices only, so the image can be written to a file and mapped back
+     *  at any address. The image only stores units between runs, code is
+     *  extracted and rendered as nodes of the abstract code model.
+     */
+    auto flatten (TranslationUnit const& unit) -> std::string;
+
+    /**
+     *  @brief Rebuilds the unit written by @c flatten from @p image .
+     *  @return nullopt if @p image is truncated, malformed or written
+     *  by other version.
+     */
+    auto expand (std::string_view image) -> std::optional<TranslationUnit>;
+}
+
+#endif
@@ -0,0 +1,102 @@
+#include "interface_names.hpp"
+
+#include "utils.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace fri
+{
+    namespace
+    {
+        /**
+         *  @brief Marks slot without a name, others hold index of a name.
+         */
+        auto constexpr EmptySlot = std::uint32_t {0xFFFFFFFF};
+    }
+
+    InterfaceNames::InterfaceNames
+        () :
+        InterfaceNames(std::vector<std::string>
+            { "AbstraktnýPamäťovýTyp"
+            , "Tabuľka"
+            , "Zásobník"
+            , "Front"
+            , "PrioritnýFront"
+            , "Zoznam"
+            , "Pole" })
+    {
+    }
+
+    InterfaceNames::InterfaceNames
+        (std::vector<std::string> names) :
+        names_ (std::move(names)),
+        slots_ (),
+        seed_  (0)
+    {
+        // Equal names would collide for any seed.
+        std::ranges::sort(names_);
+        names_.erase(std::unique(std::begin(names_), std::end(names_)), std::end(names_));
+        if (names_.empty())
+        {
+            return;
+        }
+
+        // Table has at least twice as many slots as there are names, so that
+        // a seed without collisions is found after a few attempts. If it is
+        // not, the table grows.
+        auto size = std::size_t {2};
+        while (size < 2 * names_.size())
+        {
+            size *= 2;
+        }
+
+        for (;;)
+        {
+            for (auto attempt = 0; attempt < 64; ++attempt)
+            {
+                slots_.assign(size, EmptySlot);
+                auto collides = false;
+                for (auto i = std::size_t {0}; i < names_.size() and not collides; ++i)
+                {
+                    auto& s  = slots_[this->slot(names_[i])];
+                    collides = s != EmptySlot;
+                    s        = static_cast<std::uint32_t>(i);
+                }
+
+                if (not collides)
+                {
+                    return;
+                }
+                ++seed_;
+            }
+            size *= 2;
+        }
+    }
+
+    auto InterfaceNames::is_interface
+        (std::string_view const typeName) const -> bool
+    {
+        if (names_.empty())
+        {
+            return false;
+        }
+
+        auto const name = typeName.substr(0, typeName.find('<'));
+        auto const i    = slots_[this->slot(name)];
+        return i != EmptySlot and names_[i] == name;
+    }
+
+    auto InterfaceNames::names
+        () const -> std::vector<std::string> const&
+    {
+        return names_;
+    }
+
+    auto InterfaceNames::slot
+        (std::string_view const name) const -> std::size_t
+    {
+        // Size of the table is a power of two.
+        return static_cast<std::size_t>(fnv1a(name, fnv1a({}) + seed_)) & (slots_.size() - 1);
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef FRI_INTERFACE_NAMES_HPP
+#define FRI_INTERFACE_NAMES_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fri
+{
+    /**
+     *  @brief Names of classes that are shown as interfaces. Names are
+     *  looked up by a perfect hash, so each lookup hashes the name once
+     *  and compares it with at most one name.
+     */
+    class InterfaceNames
+    {
+    public:
+        /**
+         *  @brief Names of abstract data types of the course.
+         */
+        InterfaceNames ();
+        explicit InterfaceNames (std::vector<std::string> names);
+
+        /**
+         *  @brief Checks if @p typeName without template arguments is one of the names.
+         */
+        auto is_interface (std::string_view typeName) const -> bool;
+
+        auto names () const -> std::vector<std::string> const&;
+
+    private:
+        auto slot (std::string_view name) const -> std::size_t;
+
+    private:
+        std::vector<std::string>   names_;
+        std::vector<std::uint32_t> slots_;
+        std::uint64_t              seed_;
+    };
+}
+
+#endif
@@ -1,7 +1,14 @@
+#include "batch.hpp"
 #include "clang_source_parser.hpp"
 #include "code_generator.hpp"
+#include "command_line.hpp"
+#include "server.hpp"
+#include "unit_cache.hpp"
+#include "watch.hpp"
 #include "utils.hpp"
 
+#include <chrono>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
@@ -11,6 +18,9 @@
 #include <cassert>
 #include <unordered_map>
 #include <cstring>
+#include <cstdint>
+
+#include <sys/resource.h>
 
 namespace
 {
@@ -99,6 +109,21 @@ namespace
                 }
                 settings.indentSpaces = val;
             }
+            else if (settingName == "lineWidth")
+            {
+                if (words.size() < 2)
+                {
+                    print_ignore(settingName);
+                    continue;
+                }
+                auto const val = fri::parse<unsigned int>(words[1]);
+                if (not val)
+                {
+                    print_ignore(settingName);
+                    continue;
+                }
+                settings.lineWidth = val;
+            }
             else if (settingName == "font")
             {
                 if (words.size() < 2)
@@ -186,6 +211,10 @@ namespace
                 }
 
             }
+            else if (settingName == "interfaces")
+            {
+                // Already read by try_load_interfaces.
+            }
             else
             {
                 print_ignore(settingName);
@@ -195,18 +224,93 @@ namespace
         return settings;
     }
 
-    auto output_file(OutputMode const m, char** argv)
+    /**
+     *  @brief Reads names of interfaces from line "interfaces <name>..."
+     *  of the settings. Types are classified during the extraction,
+     *  so the names are read before other settings.
+     */
+    auto try_load_interfaces()
+    {
+        auto ifst = std::ifstream("settings.txt");
+        auto line = std::string();
+        while (std::getline(ifst, line))
+        {
+            auto words = fri::to_words(std::move(line));
+            if (not words.empty() and words[0] == "interfaces")
+            {
+                words.erase(std::begin(words));
+                return fri::InterfaceNames(std::move(words));
+            }
+        }
+        return fri::InterfaceNames();
+    }
+
+    auto output_file(OutputMode const m, fri::CommandLine const& cmd)
     {
         switch (m)
         {
         case OutputMode::File:
-            return std::optional<std::ofstream>(std::in_place_t(), argv[2]);
+            return std::optional<std::ofstream>(std::in_place_t(), *cmd.output_);
 
         default:
             return std::optional<std::ofstream>(std::nullopt);
         }
     }
 
+    /**
+     *  @brief Extracts code from the input or loads it from the unit cache.
+     */
+    auto extract( fri::CommandLine const&   cmd
+                , fri::ExtractOptions const& options
+                , std::string const&         code ) -> std::optional<fri::TranslationUnit>
+    {
+        // Key is a plain number, so that it is initialized on every path.
+        auto key    = std::uint64_t {0};
+        auto cached = false;
+        if (cmd.unitCache_)
+        {
+            if (auto const hash = fri::hash_preprocessed(code, options))
+            {
+                key    = *hash;
+                cached = true;
+            }
+        }
+
+        if (cached)
+        {
+            auto unit = fri::UnitCache(*cmd.unitCache_).load(key);
+            if (unit)
+            {
+                return unit;
+            }
+        }
+
+        auto unit = options.astCache.empty()
+                        ? std::optional<fri::TranslationUnit>(fri::extract_code(code, options))
+                        : fri::extract_file(cmd.inputs_.front(), options);
+        if (unit and cached)
+        {
+            fri::UnitCache(*cmd.unitCache_).store(key, *unit);
+        }
+        return unit;
+    }
+
+    /**
+     *  @brief Prints time of extraction, peak memory usage and size of @p unit .
+     */
+    auto print_stats( fri::TranslationUnit const&        unit
+                    , std::chrono::steady_clock::duration elapsed ) -> void
+    {
+        auto usage = rusage {};
+        ::getrusage(RUSAGE_SELF, &usage);
+        auto const& arena = unit.get_arena();
+        auto const millis = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed);
+        std::cerr << "Extraction time: " << millis.count() << " ms" << '\n'
+                  << "Peak memory:     " << usage.ru_maxrss << " KiB" << '\n'
+                  << "Nodes:           " << arena.node_count() << '\n'
+                  << "Arena size:      " << arena.reserved() << " B" << '\n';
+    }
+
     using printer_variant_t = std::variant<fri::ConsoleCodePrinter, fri::RtfCodePrinter>;
 
     auto printer( OutputMode const m
@@ -234,33 +338,100 @@ namespace
 
 int main(int argc, char** argv)
 {
-    if (argc < 2)
+    auto const cmd = fri::parse_command_line(argc, argv);
+    if (not cmd)
     {
-        std::cerr << "Input file path not provided." << '\n';
         return 1;
     }
 
+    auto options = fri::ExtractOptions {};
+    if (cmd->mode_ == fri::RunMode::BuildPch)
+    {
+        return fri::build_pch(cmd->inputs_.front(), *cmd->output_, options) ? 0 : 1;
+    }
+
+    // Inputs may be parsed in other working directories.
+    if (cmd->pch_ and fri::is_pch_current(*cmd->pch_, options))
+    {
+        options.pch = std::filesystem::absolute(*cmd->pch_).string();
+    }
+
+    if (cmd->astCache_)
+    {
+        options.astCache = *cmd->astCache_;
+    }
+    options.verbose    = cmd->verbose_;
+    options.outline    = cmd->outline_;
+    options.interfaces = try_load_interfaces();
+
+    auto const load_settings = [&cmd](OutputMode const outputMode)
+    {
+        auto settings    = try_load_setting(outputMode);
+        settings.outline = cmd->outline_;
+        return settings;
+    };
+
+    // Settings are read only once, even if there are multiple inputs.
+    if (cmd->mode_ == fri::RunMode::Batch)
+    {
+        return fri::run_batch(*cmd, options, load_settings(OutputMode::File));
+    }
+
+    if (cmd->mode_ == fri::RunMode::Serve)
+    {
+        return fri::run_server(cmd->inputs_.front(), cmd->jobs_, options, load_settings(OutputMode::File));
+    }
+
+    // Single input may still use multiple threads.
+    options.bodyJobs = cmd->jobs_;
+
+    auto const& inputPath = cmd->inputs_.front();
+
     // Check if the input file is readable.
-    auto ifst = std::ifstream(argv[1]);
+    auto ifst = std::ifstream(inputPath);
     if (not ifst.is_open())
     {
-        std::cerr << "Failed to open input file: " << argv[1] << '\n';
+        std::cerr << "Failed to open input file: " << inputPath << '\n';
         return 1;
     }
 
     // If the output path is provided, try to initialize the output stream.
-    auto const outputMode = argc > 2 ? OutputMode::File : OutputMode::Console;
-    auto ofstOpt = output_file(outputMode, argv);
+    auto const outputMode = cmd->output_ ? OutputMode::File : OutputMode::Console;
+    auto ofstOpt = output_file(outputMode, *cmd);
 
     // Check if the output file is set and writable.
     if (ofstOpt.has_value() and not ofstOpt.value().is_open())
     {
-        std::cerr << "Failed to open output file: " << argv[2] << '\n';
+        std::cerr << "Failed to open output file: " << *cmd->output_ << '\n';
         return 1;
     }
 
     // Possibly read settings or use defaults.
-    auto settings = try_load_setting(outputMode);
+    auto settings = load_settings(outputMode);
+
+    // Output is rewritten in place on each change.
+    if (cmd->watch_)
+    {
+        ifst.close();
+        return fri::run_watch(inputPath, options, [&](fri::TranslationUnit const& unit)
+        {
+            ofstOpt = output_file(outputMode, *cmd);
+            if (outputMode == OutputMode::Console)
+            {
+                std::cout << "\x1b[2J\x1b[H";
+            }
+            {
+                // Printer completes the document when it is destroyed.
+                auto printerVar = printer(outputMode, ofstOpt, settings);
+                fri::generate_pseudocode(unit, printer_ref(printerVar), settings);
+            }
+            if (ofstOpt)
+            {
+                ofstOpt->flush();
+            }
+            std::cout.flush();
+        });
+    }
 
     // Read the code from the input file.
     auto ist = std::stringstream();
@@ -269,15 +440,21 @@ int main(int argc, char** argv)
 
     // Analyze the code and generate pseudocode.
     auto printerVar         = printer(outputMode, ofstOpt, settings);
-    auto decoratedPrinter   = fri::NumberedCodePrinter(printer_ref(printerVar), 3, settings.style.lineNumber_);
-    auto generator          = fri::PseudocodeGenerator(decoratedPrinter, settings.style);
-    auto const abstractCode = fri::extract_code(code);
+    auto const start        = std::chrono::steady_clock::now();
+    auto const abstractCode = extract(*cmd, options, code);
+    if (not abstractCode)
+    {
+        std::cerr << "Failed to process input file: " << inputPath << '\n';
+        return 1;
+    }
 
-    std::cout << "---------------------------------------------" << '\n';
-    for (auto const& c : abstractCode.get_classes())
+    if (cmd->stats_)
     {
-        c->accept(generator);
+        print_stats(*abstractCode, std::chrono::steady_clock::now() - start);
     }
+
+    std::cout << "---------------------------------------------" << '\n';
+    fri::generate_pseudocode(*abstractCode, printer_ref(printerVar), settings);
 }
 
 // alias <T> = <U>
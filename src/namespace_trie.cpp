@@ -0,0 +1,52 @@
+#include "namespace_trie.hpp"
+
+#include <algorithm>
+
+namespace fri
+{
+    NamespaceTrie::NamespaceTrie
+        (std::vector<std::string> const& namespaces) :
+        nodes_ (1)
+    {
+        for (auto const& path : namespaces)
+        {
+            auto node = Root;
+            auto rest = std::string_view(path);
+            while (not rest.empty())
+            {
+                auto const end  = rest.find("::");
+                auto const name = rest.substr(0, end);
+                rest = end == std::string_view::npos ? std::string_view() : rest.substr(end + 2);
+
+                auto const next = this->child(node, name);
+                if (next)
+                {
+                    node = *next;
+                    continue;
+                }
+                nodes_[node].children_.emplace_back(std::string(name), nodes_.size());
+                node = nodes_.size();
+                nodes_.emplace_back();
+            }
+            nodes_[node].complete_ = true;
+        }
+    }
+
+    auto NamespaceTrie::child
+        (node_t const parent, std::string_view const name) const -> std::optional<node_t>
+    {
+        // Only a few namespaces are configured, linear search is fine.
+        auto const& children = nodes_[parent].children_;
+        auto const it = std::ranges::find_if(children, [name](auto const& c)
+        {
+            return c.first == name;
+        });
+        return it != std::end(children) ? std::optional<node_t>(it->second) : std::nullopt;
+    }
+
+    auto NamespaceTrie::is_complete
+        (node_t const node) const -> bool
+    {
+        return nodes_[node].complete_;
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef FRI_NAMESPACE_TRIE_HPP
+#define FRI_NAMESPACE_TRIE_HPP
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace fri
+{
+    /**
+     *  @brief Prefix tree of namespace paths, e.g. "mm" or "mm::detail".
+     *  Allows traversal to decide at each namespace whether it may
+     *  contain extracted code, without building qualified names.
+     */
+    class NamespaceTrie
+    {
+    public:
+        using node_t = std::size_t;
+
+        static auto constexpr Root = node_t {0};
+
+    public:
+        explicit NamespaceTrie (std::vector<std::string> const& namespaces);
+
+        /**
+         *  @brief Finds namespace @p name nested in the one at @p parent .
+         *  @return nullopt if no configured namespace is in it.
+         */
+        auto child (node_t parent, std::string_view name) const -> std::optional<node_t>;
+
+        /**
+         *  @brief Checks whether @p node is one of the configured
+         *  namespaces, i.e. whether everything in it is extracted.
+         */
+        auto is_complete (node_t node) const -> bool;
+
+    private:
+        struct Node
+        {
+            std::vector<std::pair<std::string, node_t>> children_ {};
+            bool                                        complete_ {false};
+        };
+
+    private:
+        std::vector<Node> nodes_;
+    };
+}
+
+#endif
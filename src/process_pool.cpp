@@ -0,0 +1,333 @@
+#include "process_pool.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <optional>
+
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace fri
+{
+    auto to_string
+        (TaskStatus const s) -> std::string_view
+    {
+        switch (s)
+        {
+            case TaskStatus::Done:     return "done";
+            case TaskStatus::Failed:   return "failed";
+            case TaskStatus::Crashed:  return "crashed";
+            case TaskStatus::TimedOut: return "timed out";
+            default:                   return "unknown";
+        }
+    }
+
+    namespace
+    {
+        using steady_clock_t = std::chrono::steady_clock;
+
+        /**
+         *  @brief Worker process as seen by the coordinator.
+         */
+        struct Worker
+        {
+            pid_t                      pid_      {-1};
+            int                        taskFd_   {-1};
+            int                        resultFd_ {-1};
+            std::optional<std::size_t> task_     {};
+            steady_clock_t::time_point deadline_ {};
+        };
+
+        auto write_all
+            (int const fd, void const* const data, std::size_t const size) -> bool
+        {
+            auto const bytes = static_cast<char const*>(data);
+            auto written = std::size_t {0};
+            while (written < size)
+            {
+                auto const n = ::write(fd, bytes + written, size - written);
+                if (n < 0 and errno == EINTR)
+                {
+                    continue;
+                }
+                if (n <= 0)
+                {
+                    return false;
+                }
+                written += static_cast<std::size_t>(n);
+            }
+            return true;
+        }
+
+        auto read_all
+            (int const fd, void* const data, std::size_t const size) -> bool
+        {
+            auto const bytes = static_cast<char*>(data);
+            auto read = std::size_t {0};
+            while (read < size)
+            {
+                auto const n = ::read(fd, bytes + read, size - read);
+                if (n < 0 and errno == EINTR)
+                {
+                    continue;
+                }
+                if (n <= 0)
+                {
+                    return false;
+                }
+                read += static_cast<std::size_t>(n);
+            }
+            return true;
+        }
+
+        /**
+         *  @brief Body of a worker process. Runs tasks until the coordinator
+         *  closes the task pipe.
+         */
+        [[noreturn]] auto worker_loop
+            (int const taskFd, int const resultFd, std::function<bool (std::size_t)> const& task) -> void
+        {
+            auto index = std::uint64_t {};
+            while (read_all(taskFd, &index, sizeof(index)))
+            {
+                auto const result = static_cast<std::uint8_t>(task(static_cast<std::size_t>(index)) ? 1 : 0);
+                std::cout.flush();
+                if (not write_all(resultFd, &result, sizeof(result)))
+                {
+                    break;
+                }
+            }
+            std::cout.flush();
+            std::cerr.flush();
+            ::_exit(0);
+        }
+
+        auto close_fds
+            (Worker& w) -> void
+        {
+            if (w.taskFd_ >= 0)
+            {
+                ::close(w.taskFd_);
+            }
+            if (w.resultFd_ >= 0)
+            {
+                ::close(w.resultFd_);
+            }
+            w.taskFd_   = -1;
+            w.resultFd_ = -1;
+        }
+
+        auto start_worker
+            ( std::vector<Worker>&                     workers
+            , std::size_t const                        w
+            , std::function<bool (std::size_t)> const& task ) -> bool
+        {
+            int taskPipe[2];
+            int resultPipe[2];
+            if (::pipe(taskPipe) != 0)
+            {
+                std::cerr << "Failed to create pipe: " << std::strerror(errno) << '\n';
+                return false;
+            }
+            if (::pipe(resultPipe) != 0)
+            {
+                std::cerr << "Failed to create pipe: " << std::strerror(errno) << '\n';
+                ::close(taskPipe[0]);
+                ::close(taskPipe[1]);
+                return false;
+            }
+
+            // Buffered output would be written twice otherwise.
+            std::cout.flush();
+            std::cerr.flush();
+
+            auto const pid = ::fork();
+            if (pid < 0)
+            {
+                std::cerr << "Failed to start worker: " << std::strerror(errno) << '\n';
+                for (auto const fd : {taskPipe[0], taskPipe[1], resultPipe[0], resultPipe[1]})
+                {
+                    ::close(fd);
+                }
+                return false;
+            }
+
+            if (pid == 0)
+            {
+                // Pipes of other workers must not be kept open, otherwise
+                // they would not see the end of their task pipe.
+                for (auto& other : workers)
+                {
+                    close_fds(other);
+                }
+                ::close(taskPipe[1]);
+                ::close(resultPipe[0]);
+                worker_loop(taskPipe[0], resultPipe[1], task);
+            }
+
+            ::close(taskPipe[0]);
+            ::close(resultPipe[1]);
+            workers[w] = Worker {pid, taskPipe[1], resultPipe[0]};
+            return true;
+        }
+
+        auto stop_worker
+            (Worker& w, bool const kill) -> void
+        {
+            if (kill)
+            {
+                ::kill(w.pid_, SIGKILL);
+            }
+            close_fds(w);
+            auto status = 0;
+            while (::waitpid(w.pid_, &status, 0) < 0 and errno == EINTR)
+            {
+            }
+            w = Worker {};
+        }
+    }
+
+    auto run_in_processes
+        ( std::size_t const                        taskCount
+        , unsigned const                           workerCount
+        , std::chrono::seconds const               timeout
+        , std::function<bool (std::size_t)> const& task ) -> std::vector<TaskFailure>
+    {
+        // Writing into a pipe of a crashed worker must not kill the coordinator.
+        auto const oldSigpipe = std::signal(SIGPIPE, SIG_IGN);
+
+        auto failures = std::vector<TaskFailure>();
+        auto workers  = std::vector<Worker>(std::min<std::size_t>(workerCount, taskCount));
+        for (auto w = 0u; w < workers.size(); ++w)
+        {
+            start_worker(workers, w, task);
+        }
+
+        auto const finish_task = [&failures](Worker& w, TaskStatus const status)
+        {
+            if (status != TaskStatus::Done)
+            {
+                failures.emplace_back(TaskFailure {*w.task_, status});
+            }
+            w.task_.reset();
+        };
+
+        auto const restart = [&workers, &task](std::size_t const w, bool const kill)
+        {
+            stop_worker(workers[w], kill);
+            start_worker(workers, w, task);
+        };
+
+        auto next     = std::size_t {0};
+        auto finished = std::size_t {0};
+        while (finished < taskCount)
+        {
+            // Hand out tasks to idle workers.
+            for (auto w = 0u; w < workers.size() and next < taskCount; ++w)
+            {
+                auto& worker = workers[w];
+                if (worker.pid_ < 0 or worker.task_)
+                {
+                    continue;
+                }
+                auto const index = static_cast<std::uint64_t>(next);
+                if (not write_all(worker.taskFd_, &index, sizeof(index)))
+                {
+                    restart(w, true);
+                    continue;
+                }
+                worker.task_     = next;
+                worker.deadline_ = steady_clock_t::now() + timeout;
+                ++next;
+            }
+
+            // Wait for results of busy workers.
+            auto fds     = std::vector<pollfd>();
+            auto owners  = std::vector<std::size_t>();
+            auto waitFor = std::chrono::milliseconds(timeout);
+            auto const now = steady_clock_t::now();
+            for (auto w = 0u; w < workers.size(); ++w)
+            {
+                if (workers[w].task_)
+                {
+                    fds.emplace_back(pollfd {workers[w].resultFd_, POLLIN, 0});
+                    owners.emplace_back(w);
+                    auto const left = std::chrono::duration_cast<std::chrono::milliseconds>(workers[w].deadline_ - now);
+                    waitFor = std::clamp(left, std::chrono::milliseconds(0), waitFor);
+                }
+            }
+
+            if (fds.empty())
+            {
+                // No worker could be started, the rest of the tasks can not be run.
+                break;
+            }
+
+            auto const ready = ::poll(fds.data(), fds.size(), static_cast<int>(waitFor.count()));
+            if (ready < 0 and errno != EINTR)
+            {
+                std::cerr << "Failed to wait for workers: " << std::strerror(errno) << '\n';
+                break;
+            }
+
+            for (auto i = 0u; i < fds.size(); ++i)
+            {
+                auto const w = owners[i];
+                auto& worker = workers[w];
+                if (fds[i].revents == 0)
+                {
+                    if (steady_clock_t::now() >= worker.deadline_)
+                    {
+                        finish_task(worker, TaskStatus::TimedOut);
+                        ++finished;
+                        restart(w, true);
+                    }
+                    continue;
+                }
+
+                auto result = std::uint8_t {};
+                if (read_all(worker.resultFd_, &result, sizeof(result)))
+                {
+                    finish_task(worker, result ? TaskStatus::Done : TaskStatus::Failed);
+                    ++finished;
+                }
+                else
+                {
+                    finish_task(worker, TaskStatus::Crashed);
+                    ++finished;
+                    restart(w, false);
+                }
+            }
+        }
+
+        // Closing task pipes lets idle workers exit. Tasks that were
+        // still running or not started, e.g. after waiting failed,
+        // did not succeed.
+        for (auto& worker : workers)
+        {
+            auto const busy = worker.task_.has_value();
+            if (busy)
+            {
+                finish_task(worker, TaskStatus::Failed);
+            }
+            if (worker.pid_ >= 0)
+            {
+                stop_worker(worker, busy);
+            }
+        }
+        for (; next < taskCount; ++next)
+        {
+            failures.emplace_back(TaskFailure {next, TaskStatus::Failed});
+        }
+
+        std::signal(SIGPIPE, oldSigpipe);
+        std::ranges::sort(failures, {}, &TaskFailure::task_);
+        return failures;
+    }
+}
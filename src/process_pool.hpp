@@ -0,0 +1,45 @@
+#ifndef FRI_PROCESS_POOL_HPP
+#define FRI_PROCESS_POOL_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+namespace fri
+{
+    /**
+     *  @brief How a task run by a worker process ended.
+     */
+    enum class TaskStatus
+    {
+        Done, Failed, Crashed, TimedOut
+    };
+
+    auto to_string (TaskStatus) -> std::string_view;
+
+    /**
+     *  @brief Task that did not end with @c TaskStatus::Done .
+     */
+    struct TaskFailure
+    {
+        std::size_t task_;
+        TaskStatus  status_;
+    };
+
+    /**
+     *  @brief Runs tasks @c 0 ... @p taskCount - 1 in @p workerCount pre-forked
+     *  worker processes. Workers receive task indices over pipes. A worker
+     *  that crashes or does not finish a task within @p timeout is replaced
+     *  by a new one and the remaining tasks are processed normally.
+     *  @param task runs in a worker, returns false if the task failed.
+     *  @return tasks that did not succeed, ordered by index.
+     */
+    auto run_in_processes ( std::size_t                              taskCount
+                          , unsigned                                 workerCount
+                          , std::chrono::seconds                     timeout
+                          , std::function<bool (std::size_t)> const& task ) -> std::vector<TaskFailure>;
+}
+
+#endif
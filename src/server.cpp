@@ -0,0 +1,601 @@
+#include "server.hpp"
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace fri
+{
+    namespace
+    {
+        enum class Format : std::uint8_t
+        {
+            Plain = 0, Rtf = 1
+        };
+
+        enum class Status : std::uint8_t
+        {
+            Ok = 0, Error = 1
+        };
+
+        auto constexpr MaxRequestSize      = std::uint32_t {64 * 1024 * 1024};
+        auto constexpr MaxPendingResponses = std::size_t {64};
+
+        auto constexpr OutlineFlag    = std::uint8_t {1};
+        auto constexpr NamespacesFlag = std::uint8_t {2};
+        auto constexpr InterfacesFlag = std::uint8_t {4};
+
+        auto read_all
+            (int const fd, char* data, std::size_t size) -> bool
+        {
+            while (size > 0)
+            {
+                auto const n = ::recv(fd, data, size, 0);
+                if (n < 0 and errno == EINTR)
+                {
+                    continue;
+                }
+                if (n <= 0)
+                {
+                    return false;
+                }
+                data += n;
+                size -= static_cast<std::size_t>(n);
+            }
+            return true;
+        }
+
+        auto write_all
+            (int const fd, char const* data, std::size_t size) -> bool
+        {
+            while (size > 0)
+            {
+                // Client that disconnected must not kill the server.
+                auto const n = ::send(fd, data, size, MSG_NOSIGNAL);
+                if (n < 0 and errno == EINTR)
+                {
+                    continue;
+                }
+                if (n <= 0)
+                {
+                    return false;
+                }
+                data += n;
+                size -= static_cast<std::size_t>(n);
+            }
+            return true;
+        }
+
+        /**
+         *  @brief Takes 4 byte little-endian number from the front of @p data .
+         */
+        auto take_number
+            (std::string_view& data) -> std::optional<std::uint32_t>
+        {
+            if (data.size() < 4)
+            {
+                return std::nullopt;
+            }
+
+            auto number = std::uint32_t {0};
+            for (auto i = 0u; i < 4; ++i)
+            {
+                number |= static_cast<std::uint32_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+            }
+            data.remove_prefix(4);
+            return number;
+        }
+
+        /**
+         *  @brief Takes list of names from the front of @p data .
+         *  @return nullopt if the list is truncated.
+         */
+        auto take_names
+            (std::string_view& data) -> std::optional<std::vector<std::string>>
+        {
+            auto const count = take_number(data);
+            if (not count)
+            {
+                return std::nullopt;
+            }
+
+            // Each name takes at least its length, so a bogus count ends early.
+            auto names = std::vector<std::string>();
+            for (auto i = 0u; i < *count; ++i)
+            {
+                auto const size = take_number(data);
+                if (not size or *size > data.size())
+                {
+                    return std::nullopt;
+                }
+                names.emplace_back(data.substr(0, *size));
+                data.remove_prefix(*size);
+            }
+            return names;
+        }
+
+        /**
+         *  @brief Reads payload of one message.
+         *  @return nullopt at the end of the connection or if the message is invalid.
+         */
+        auto read_message
+            (int const fd) -> std::optional<std::string>
+        {
+            auto header = std::array<unsigned char, 4>();
+            if (not read_all(fd, reinterpret_cast<char*>(header.data()), header.size()))
+            {
+                return std::nullopt;
+            }
+
+            auto size = std::uint32_t {0};
+            for (auto i = 0u; i < header.size(); ++i)
+            {
+                size |= static_cast<std::uint32_t>(header[i]) << (8 * i);
+            }
+            if (size > MaxRequestSize)
+            {
+                std::cerr << "Request too large: " << size << '\n';
+                return std::nullopt;
+            }
+
+            auto payload = std::string(size, '\0');
+            if (not read_all(fd, payload.data(), payload.size()))
+            {
+                return std::nullopt;
+            }
+            return payload;
+        }
+
+        /**
+         *  @brief Creates response message.
+         */
+        auto frame
+            (Status const status, std::string_view const payload) -> std::string
+        {
+            auto const size = static_cast<std::uint32_t>(payload.size() + 1);
+            auto message    = std::string();
+            message.reserve(size + 4);
+            for (auto i = 0u; i < 4; ++i)
+            {
+                message.push_back(static_cast<char>((size >> (8 * i)) & 0xFF));
+            }
+            message.push_back(static_cast<char>(status));
+            message.append(payload);
+            return message;
+        }
+
+        /**
+         *  @brief Extracts code from @p request and renders it in requested format.
+         *  Options that the request does not set are taken from @p defaults .
+         *  @return response message.
+         */
+        auto process
+            ( CodeExtractor&        extractor
+            , std::string_view      request
+            , ExtractOptions const& defaults
+            , OutputSettings const& settings ) -> std::string
+        {
+            if (request.empty() or static_cast<std::uint8_t>(request.front()) > static_cast<std::uint8_t>(Format::Rtf))
+            {
+                return frame(Status::Error, "Unknown output format.");
+            }
+            auto const format = static_cast<Format>(request.front());
+            request.remove_prefix(1);
+
+            if (request.empty())
+            {
+                return frame(Status::Error, "Missing options.");
+            }
+            auto const flags = static_cast<std::uint8_t>(request.front());
+            request.remove_prefix(1);
+
+            auto options = defaults;
+            options.outline = options.outline or (flags & OutlineFlag) != 0;
+            if (flags & NamespacesFlag)
+            {
+                auto names = take_names(request);
+                if (not names)
+                {
+                    return frame(Status::Error, "Malformed list of namespaces.");
+                }
+                options.namespaces = std::move(*names);
+            }
+            if (flags & InterfacesFlag)
+            {
+                auto names = take_names(request);
+                if (not names)
+                {
+                    return frame(Status::Error, "Malformed list of interfaces.");
+                }
+                options.interfaces = InterfaceNames(std::move(*names));
+            }
+
+            auto const unit = extractor.extract(std::string(request), options);
+            if (not unit)
+            {
+                return frame(Status::Error, "Failed to parse the code.");
+            }
+
+            auto ost = std::ostringstream();
+            if (format == Format::Rtf)
+            {
+                // Printer completes the document when it is destroyed.
+                auto printer = RtfCodePrinter(ost, settings);
+                generate_pseudocode(*unit, printer, settings);
+            }
+            else
+            {
+                auto printer = PlainCodePrinter(ost, settings);
+                generate_pseudocode(*unit, printer, settings);
+            }
+            return frame(Status::Ok, ost.str());
+        }
+
+        /**
+         *  @brief Threads that process requests of all connections.
+         *  Each of them keeps its own extractor.
+         */
+        class WorkerPool
+        {
+        public:
+            using task_t = std::function<void (CodeExtractor&)>;
+
+            WorkerPool (unsigned count, ExtractOptions const& options);
+            ~WorkerPool ();
+
+            auto submit (task_t task) -> void;
+
+        private:
+            auto run (CodeExtractor extractor) -> void;
+
+        private:
+            std::mutex               mutex_;
+            std::condition_variable  ready_;
+            std::deque<task_t>       tasks_;
+            bool                     stop_ {false};
+            std::vector<std::thread> threads_;
+        };
+
+        /**
+         *  @brief Responses of one connection in the order of its requests.
+         *  Limits the number of pending requests of the connection.
+         */
+        class ResponseQueue
+        {
+        public:
+            /**
+             *  @brief Waits for a free slot.
+             *  @return false if the queue was closed.
+             */
+            auto push (std::future<std::string> response) -> bool;
+
+            /**
+             *  @brief Waits for the next response.
+             *  @return nullopt if the queue was closed and all responses were taken.
+             */
+            auto pop () -> std::optional<std::future<std::string>>;
+
+            auto close () -> void;
+
+        private:
+            std::mutex                           mutex_;
+            std::condition_variable              changed_;
+            std::deque<std::future<std::string>> responses_;
+            bool                                 closed_ {false};
+        };
+
+        /**
+         *  @brief Connected client served by its own thread.
+         */
+        struct Connection
+        {
+            int                                fd_;
+            std::shared_ptr<std::atomic<bool>> done_;
+            std::thread                        thread_;
+        };
+
+        /**
+         *  @brief Reads requests of a client and submits them to @p pool .
+         *  Responses are written by another thread as they become ready.
+         */
+        auto serve_connection
+            ( int const             fd
+            , WorkerPool&           pool
+            , ExtractOptions const& options
+            , OutputSettings const& settings ) -> void
+        {
+            auto responses = ResponseQueue();
+            auto writer    = std::thread([fd, &responses]()
+            {
+                while (auto response = responses.pop())
+                {
+                    auto const message = response->get();
+                    if (not write_all(fd, message.data(), message.size()))
+                    {
+                        // Unblocks the reader.
+                        responses.close();
+                        ::shutdown(fd, SHUT_RDWR);
+                        break;
+                    }
+                }
+            });
+
+            while (auto request = read_message(fd))
+            {
+                auto promise = std::make_shared<std::promise<std::string>>();
+                if (not responses.push(promise->get_future()))
+                {
+                    break;
+                }
+
+                pool.submit([promise, request = std::move(*request), &options, &settings](CodeExtractor& extractor)
+                {
+                    promise->set_value(process(extractor, request, options, settings));
+                });
+            }
+
+            responses.close();
+            writer.join();
+        }
+
+        /**
+         *  @brief Checks whether a server accepts connections at @p address .
+         *  @return false if it does not, errno tells why.
+         */
+        auto is_served
+            (sockaddr_un const& address) -> bool
+        {
+            auto const fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (fd < 0)
+            {
+                return false;
+            }
+            auto const connected = ::connect(fd, reinterpret_cast<sockaddr const*>(&address), sizeof(address)) == 0;
+            auto const error     = errno;
+            ::close(fd);
+            errno = error;
+            return connected;
+        }
+
+        /**
+         *  @brief Creates listening socket at @p path .
+         *  @return socket or -1 on error.
+         */
+        auto listen_at
+            (std::string const& path) -> int
+        {
+            auto address = sockaddr_un {};
+            address.sun_family = AF_UNIX;
+            if (path.size() >= sizeof(address.sun_path))
+            {
+                std::cerr << "Socket path is too long: " << path << '\n';
+                return -1;
+            }
+            std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+            // Socket left by a server that did not exit cleanly is replaced.
+            if (is_served(address))
+            {
+                std::cerr << "Server is already running: " << path << '\n';
+                return -1;
+            }
+            if (errno == ECONNREFUSED)
+            {
+                ::unlink(path.c_str());
+            }
+
+            auto const fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (fd < 0)
+            {
+                std::cerr << "Failed to create socket: " << std::strerror(errno) << '\n';
+                return -1;
+            }
+
+            if (::bind(fd, reinterpret_cast<sockaddr const*>(&address), sizeof(address)) < 0
+             or ::listen(fd, SOMAXCONN) < 0)
+            {
+                std::cerr << "Failed to listen at " << path << ": " << std::strerror(errno) << '\n';
+                ::close(fd);
+                return -1;
+            }
+            return fd;
+        }
+
+// WorkerPool definitions:
+
+        WorkerPool::WorkerPool
+            (unsigned const count, ExtractOptions const& options)
+        {
+            for (auto i = 0u; i < count; ++i)
+            {
+                threads_.emplace_back([this, options]()
+                {
+                    this->run(CodeExtractor(options));
+                });
+            }
+        }
+
+        WorkerPool::~WorkerPool
+            ()
+        {
+            {
+                auto lock = std::scoped_lock(mutex_);
+                stop_ = true;
+            }
+            ready_.notify_all();
+            for (auto& thread : threads_)
+            {
+                thread.join();
+            }
+        }
+
+        auto WorkerPool::submit
+            (task_t task) -> void
+        {
+            {
+                auto lock = std::scoped_lock(mutex_);
+                tasks_.emplace_back(std::move(task));
+            }
+            ready_.notify_one();
+        }
+
+        auto WorkerPool::run
+            (CodeExtractor extractor) -> void
+        {
+            for (;;)
+            {
+                auto task = task_t();
+                {
+                    auto lock = std::unique_lock(mutex_);
+                    ready_.wait(lock, [this]()
+                    {
+                        return stop_ or not tasks_.empty();
+                    });
+                    if (tasks_.empty())
+                    {
+                        return;
+                    }
+                    task = std::move(tasks_.front());
+                    tasks_.pop_front();
+                }
+                task(extractor);
+            }
+        }
+
+// ResponseQueue definitions:
+
+        auto ResponseQueue::push
+            (std::future<std::string> response) -> bool
+        {
+            {
+                auto lock = std::unique_lock(mutex_);
+                changed_.wait(lock, [this]()
+                {
+                    return closed_ or responses_.size() < MaxPendingResponses;
+                });
+                if (closed_)
+                {
+                    return false;
+                }
+                responses_.emplace_back(std::move(response));
+            }
+            changed_.notify_all();
+            return true;
+        }
+
+        auto ResponseQueue::pop
+            () -> std::optional<std::future<std::string>>
+        {
+            auto response = std::future<std::string>();
+            {
+                auto lock = std::unique_lock(mutex_);
+                changed_.wait(lock, [this]()
+                {
+                    return closed_ or not responses_.empty();
+                });
+                if (responses_.empty())
+                {
+                    return std::nullopt;
+                }
+                response = std::move(responses_.front());
+                responses_.pop_front();
+            }
+            changed_.notify_all();
+            return response;
+        }
+
+        auto ResponseQueue::close
+            () -> void
+        {
+            {
+                auto lock = std::scoped_lock(mutex_);
+                closed_ = true;
+            }
+            changed_.notify_all();
+        }
+    }
+
+    auto run_server
+        ( std::string const&    socketPath
+        , unsigned const        workers
+        , ExtractOptions const& options
+        , OutputSettings const& settings ) -> int
+    {
+        auto const listener = listen_at(socketPath);
+        if (listener < 0)
+        {
+            return 1;
+        }
+
+        auto pool        = WorkerPool(workers, options);
+        auto connections = std::list<Connection>();
+        std::cout << "Serving at " << socketPath << " with " << workers << " worker(s)" << std::endl;
+
+        for (;;)
+        {
+            auto const fd = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd < 0)
+            {
+                if (errno == EINTR or errno == ECONNABORTED)
+                {
+                    continue;
+                }
+                std::cerr << "Failed to accept connection: " << std::strerror(errno) << '\n';
+                break;
+            }
+
+            // Finished connections are cleaned up here, there is nobody else to do it.
+            // Sockets are closed only after their threads finish, so that
+            // the descriptors are not reused while they may be shut down.
+            connections.remove_if([](Connection& c)
+            {
+                if (not c.done_->load())
+                {
+                    return false;
+                }
+                c.thread_.join();
+                ::close(c.fd_);
+                return true;
+            });
+
+            auto done   = std::make_shared<std::atomic<bool>>(false);
+            auto thread = std::thread([fd, done, &pool, &options, &settings]()
+            {
+                serve_connection(fd, pool, options, settings);
+                ::shutdown(fd, SHUT_RDWR);
+                done->store(true);
+            });
+            connections.push_back(Connection {fd, std::move(done), std::move(thread)});
+        }
+
+        // Pool outlives the connections that submit to it.
+        for (auto& c : connections)
+        {
+            ::shutdown(c.fd_, SHUT_RDWR);
+            c.thread_.join();
+            ::close(c.fd_);
+        }
+        ::close(listener);
+        ::unlink(socketPath.c_str());
+        return 1;
+    }
+}
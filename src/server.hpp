@@ -0,0 +1,38 @@
+#ifndef FRI_SERVER_HPP
+#define FRI_SERVER_HPP
+
+#include "clang_source_parser.hpp"
+#include "code_generator.hpp"
+
+#include <string>
+
+namespace fri
+{
+    /**
+     *  @brief Serves pseudocode generation requests on Unix domain socket
+     *  at @p socketPath . Settings and state of clang are loaded once
+     *  and shared by all requests.
+     *
+     *  Each message is a 4 byte little-endian length followed by the payload.
+     *  Payload of a request is a format byte (0 plain text, 1 RTF), a byte
+     *  of option flags and the code. Flag 1 extracts only the outline even
+     *  if @p options do not. Flag 2 replaces namespaces of @p options and
+     *  flag 4 interface names, each by a list that precedes the code,
+     *  namespaces first. A list is a 4 byte count of names, each name is
+     *  a 4 byte length followed by the name. Other options are those
+     *  of @p options .
+     *
+     *  Payload of a response is a status byte (0 success, 1 error) followed
+     *  by the output or an error message. Clients may send multiple requests
+     *  without waiting, responses come in the order of the requests.
+     *
+     *  @param workers number of requests processed concurrently.
+     *  @return exit code of the program.
+     */
+    auto run_server ( std::string const&    socketPath
+                    , unsigned              workers
+                    , ExtractOptions const& options
+                    , OutputSettings const& settings ) -> int;
+}
+
+#endif
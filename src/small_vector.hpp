@@ -0,0 +1,312 @@
+#ifndef FRI_SMALL_VECTOR_HPP
+#define FRI_SMALL_VECTOR_HPP
+
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace fri
+{
+    /**
+     *  @brief Sequence that keeps up to @p N elements inside of itself
+     *  and moves them to the heap only when there are more of them.
+     *  Arguments and parameters usually fit, so nodes that hold them
+     *  do not allocate anything besides the node.
+     */
+    template<class T, std::size_t N>
+    class SmallVector
+    {
+        static_assert(N > 0);
+        static_assert(std::is_nothrow_move_constructible_v<T>);
+
+    public:
+        using value_type     = T;
+        using size_type      = std::size_t;
+        using iterator       = T*;
+        using const_iterator = T const*;
+
+        SmallVector ();
+        SmallVector (std::initializer_list<T> ts);
+        SmallVector (SmallVector const& other);
+        SmallVector (SmallVector&& other) noexcept;
+        ~SmallVector ();
+
+        auto operator= (SmallVector const& other) -> SmallVector&;
+        auto operator= (SmallVector&& other) noexcept -> SmallVector&;
+
+        auto begin () -> iterator;
+        auto end   () -> iterator;
+        auto begin () const -> const_iterator;
+        auto end   () const -> const_iterator;
+
+        auto operator[] (size_type i) -> T&;
+        auto operator[] (size_type i) const -> T const&;
+
+        auto size     () const -> size_type;
+        auto capacity () const -> size_type;
+        auto empty    () const -> bool;
+
+        /**
+         *  @brief Checks if elements are stored inside of the vector.
+         */
+        auto is_inline () const -> bool;
+
+        template<class... Args>
+        auto emplace_back (Args&&... args) -> T&;
+        auto push_back    (T t) -> void;
+        auto reserve      (size_type capacity) -> void;
+        auto clear        () -> void;
+
+    private:
+        auto inline_data () -> T*;
+
+        /**
+         *  @brief Frees heap storage and switches back to inline one.
+         *  Vector must be empty.
+         */
+        auto release () -> void;
+
+        /**
+         *  @brief Takes elements of @p other , which is left empty.
+         *  This vector must be empty and inline.
+         */
+        auto steal (SmallVector& other) -> void;
+
+    private:
+        T*        data_;
+        size_type size_;
+        size_type capacity_;
+        alignas(T) std::byte inline_ [N * sizeof(T)];
+    };
+
+// SmallVector definitions:
+
+    template<class T, std::size_t N>
+    SmallVector<T, N>::SmallVector
+        () :
+        data_     (this->inline_data()),
+        size_     (0),
+        capacity_ (N)
+    {
+    }
+
+    template<class T, std::size_t N>
+    SmallVector<T, N>::SmallVector
+        (std::initializer_list<T> const ts) :
+        SmallVector()
+    {
+        this->reserve(ts.size());
+        std::uninitialized_copy(std::begin(ts), std::end(ts), data_);
+        size_ = ts.size();
+    }
+
+    template<class T, std::size_t N>
+    SmallVector<T, N>::SmallVector
+        (SmallVector const& other) :
+        SmallVector()
+    {
+        this->reserve(other.size_);
+        std::uninitialized_copy(other.begin(), other.end(), data_);
+        size_ = other.size_;
+    }
+
+    template<class T, std::size_t N>
+    SmallVector<T, N>::SmallVector
+        (SmallVector&& other) noexcept :
+        SmallVector()
+    {
+        this->steal(other);
+    }
+
+    template<class T, std::size_t N>
+    SmallVector<T, N>::~SmallVector
+        ()
+    {
+        this->clear();
+        this->release();
+    }
+
+    template<class T, std::size_t N>
+    auto SmallVector<T, N>::operator=
+        (SmallVector const& other) -> SmallVector&
+    {
+        auto copy = SmallVector(other);
+        return *this = std::move(copy);
+    }
+
+    template<class T, std::size_t N>
+    auto SmallVector<T, N>::operator=
+        (SmallVector&& other) noexcept -> SmallVector&
+    {
+        if (this != &other)
+        {
+            this->clear();
+            this->release();
+            this->steal(other);
+        }
+        return *this;
+    }
+
+    template<class T, std::size_t N>
+    auto SmallVector<T, N>::begin
+        () -> iterator
+    {
+        return data_;
+    }
+
+    template<class T, std::size_t N>
+    auto SmallVector<T, N>::end
+        () -> iterator
+    {
+        return data_ + size_;
+    }
+
+    template<class T, std::size_t N>
+    auto SmallVector<T, N>::begin
+        () const -> const_iterator
+    {
+        return data_;
+    }
+
+    template<class T, std::size_t N>
+    auto SmallVector<T, N>::end
+        () const -> const_iterator
+    {
+        return data_ + size_;
+    }
+
+    template<class T, std::size_t N>
+    auto SmallVector<T, N>::operator[]
+        (size_type const i) -> T&
+    {
+        return data_[i];
+    }
+
+    template<class T, std::size_t N>
+    auto SmallVector<T, N>::operator[]
+        (size_type const i) const -> T const&
+    {
+        return data_[i];
+    }
+
+    template<class T, std::size_t N>
+    auto SmallVector<T, N>::size
+        () const -> size_type
+    {
+        return size_;
+    }
+
+    template<class T, std::size_t N>
+    auto SmallVector<T, N>::capacity
+        () const -> size_type
+    {
+        return capacity_;
+    }
+
+    template<class T, std::size_t N>
+    auto SmallVector<T, N>::empty
+        () const -> bool
+    {
+        return size_ == 0;
+    }
+
+    template<class T, std::size_t N>
+    auto SmallVector<T, N>::is_inline
+        () const -> bool
+    {
+        return data_ == reinterpret_cast<T const*>(inline_);
+    }
+
+    template<class T, std::size_t N>
+    template<class... Args>
+    auto SmallVector<T, N>::emplace_back
+        (Args&&... args) -> T&
+    {
+        if (size_ == capacity_)
+        {
+            // Arguments may refer to an element that is about to move.
+            auto t = T(std::forward<Args>(args)...);
+            this->reserve(2 * capacity_);
+            return *::new (data_ + size_++) T(std::move(t));
+        }
+        return *::new (data_ + size_++) T(std::forward<Args>(args)...);
+    }
+
+    template<class T, std::size_t N>
+    auto SmallVector<T, N>::push_back
+        (T t) -> void
+    {
+        this->emplace_back(std::move(t));
+    }
+
+    template<class T, std::size_t N>
+    auto SmallVector<T, N>::reserve
+        (size_type const capacity) -> void
+    {
+        if (capacity <= capacity_)
+        {
+            return;
+        }
+        auto const ts = std::allocator<T>().allocate(capacity);
+        std::uninitialized_move(this->begin(), this->end(), ts);
+        auto const size = size_;
+        this->clear();
+        this->release();
+        data_     = ts;
+        size_     = size;
+        capacity_ = capacity;
+    }
+
+    template<class T, std::size_t N>
+    auto SmallVector<T, N>::clear
+        () -> void
+    {
+        std::destroy(this->begin(), this->end());
+        size_ = 0;
+    }
+
+    template<class T, std::size_t N>
+    auto SmallVector<T, N>::inline_data
+        () -> T*
+    {
+        return reinterpret_cast<T*>(inline_);
+    }
+
+    template<class T, std::size_t N>
+    auto SmallVector<T, N>::release
+        () -> void
+    {
+        if (not this->is_inline())
+        {
+            std::allocator<T>().deallocate(data_, capacity_);
+            data_     = this->inline_data();
+            capacity_ = N;
+        }
+    }
+
+    template<class T, std::size_t N>
+    auto SmallVector<T, N>::steal
+        (SmallVector& other) -> void
+    {
+        if (other.is_inline())
+        {
+            std::uninitialized_move(other.begin(), other.end(), data_);
+            size_ = other.size_;
+            other.clear();
+        }
+        else
+        {
+            data_           = other.data_;
+            size_           = other.size_;
+            capacity_       = other.capacity_;
+            other.data_     = other.inline_data();
+            other.size_     = 0;
+            other.capacity_ = N;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,181 @@
+#include "type_pool.hpp"
+
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <variant>
+
+namespace fri
+{
+    namespace
+    {
+        /**
+         *  @brief Builds key that identifies type by its kind, constness
+         *  and identities of its parts. Parts are types from the same pool
+         *  and symbols from the same arena, so their addresses suffice.
+         */
+        class TypeKey
+        {
+        public:
+            TypeKey (char kind, IsConst isConst);
+
+            auto add (char)        -> TypeKey&;
+            auto add (void const*) -> TypeKey&;
+            auto add (Symbol)      -> TypeKey&;
+            auto str ()            -> std::string;
+
+        private:
+            std::string key_;
+        };
+
+// TypeKey definitions:
+
+        TypeKey::TypeKey
+            (char const kind, IsConst const isConst) :
+            key_ {kind, isConst ? '1' : '0'}
+        {
+        }
+
+        auto TypeKey::add
+            (char const c) -> TypeKey&
+        {
+            key_.push_back(c);
+            return *this;
+        }
+
+        auto TypeKey::add
+            (void const* const p) -> TypeKey&
+        {
+            auto const address = reinterpret_cast<std::uintptr_t>(p);
+            key_.append(reinterpret_cast<char const*>(&address), sizeof(address));
+            return *this;
+        }
+
+        auto TypeKey::add
+            (Symbol const s) -> TypeKey&
+        {
+            auto const size = s.view().size();
+            key_.append(reinterpret_cast<char const*>(&size), sizeof(size));
+            return this->add(static_cast<void const*>(s.view().data()));
+        }
+
+        auto TypeKey::str
+            () -> std::string
+        {
+            return std::move(key_);
+        }
+    }
+
+// TypePool definitions:
+
+    TypePool::TypePool
+        (Arena& arena, InterfaceNames const& interfaces) :
+        arena_      (&arena),
+        interfaces_ (&interfaces),
+        types_      (),
+        sources_    (),
+        mutex_      ()
+    {
+    }
+
+    TypePool::TypePool
+        (Arena& arena) :
+        arena_      (&arena),
+        interfaces_ (nullptr),
+        types_      (),
+        sources_    (),
+        mutex_      ()
+    {
+    }
+
+    auto TypePool::prim_type
+        (IsConst const isConst, Symbol const name) -> Type*
+    {
+        return this->cons<PrimType>(TypeKey('P', isConst).add(name).str(), isConst, name);
+    }
+
+    auto TypePool::custom_type
+        (IsConst const isConst, Symbol const name) -> Type*
+    {
+        return this->cons<CustomType>(TypeKey('C', isConst).add(name).str(), isConst, name);
+    }
+
+    auto TypePool::templated_type
+        (IsConst const isConst, Type* const base, std::vector<TemplatedType::arg_var_t> args) -> Type*
+    {
+        auto key = TypeKey('T', isConst);
+        key.add(base);
+        for (auto const& arg : args)
+        {
+            // Missing type and missing expression are both null.
+            std::visit([&key](auto const a)
+            {
+                key.add(static_cast<void const*>(a));
+            }, arg);
+            key.add(arg.index() == 0 ? 't' : 'e');
+        }
+        return this->cons<TemplatedType>(key.str(), isConst, base, std::move(args));
+    }
+
+    auto TypePool::indirection
+        (IsConst const isConst, Type* const pointee) -> Type*
+    {
+        return this->cons<Indirection>(TypeKey('I', isConst).add(pointee).str(), isConst, pointee);
+    }
+
+    auto TypePool::function
+        (std::vector<Type*> params, Type* const ret) -> Type*
+    {
+        auto key = TypeKey('F', IsConst(false));
+        key.add(ret);
+        for (auto const param : params)
+        {
+            key.add(param);
+        }
+        return this->cons<Function>(key.str(), std::move(params), ret);
+    }
+
+    auto TypePool::nested
+        (IsConst const isConst, Type* const nest, Symbol const name) -> Type*
+    {
+        return this->cons<Nested>(TypeKey('N', isConst).add(nest).add(name).str(), isConst, nest, name);
+    }
+
+    auto TypePool::find
+        (void const* const source, IsConst const isConst) const -> Type*
+    {
+        auto const lock     = std::scoped_lock(mutex_);
+        auto const& sources = sources_[isConst ? 1 : 0];
+        auto const it = sources.find(source);
+        return it != std::end(sources) ? it->second : nullptr;
+    }
+
+    auto TypePool::remember
+        (void const* const source, IsConst const isConst, Type* const type) -> void
+    {
+        auto const lock = std::scoped_lock(mutex_);
+        sources_[isConst ? 1 : 0].emplace(source, type);
+    }
+
+    template<class T, class... Args>
+    auto TypePool::cons
+        (std::string key, Args&&... args) -> Type*
+    {
+        auto const lock = std::scoped_lock(mutex_);
+        auto const it = types_.find(key);
+        if (it != std::end(types_))
+        {
+            return it->second;
+        }
+        auto const type = arena_->make<T>(std::forward<Args>(args)...);
+        auto const name = type->to_string();
+        type->isVoid_        = name == "void";
+        type->isStdFunction_ = T::Kind == NodeKind::TemplatedType and name.starts_with("function");
+        if (interfaces_)
+        {
+            type->isInterface_ = interfaces_->is_interface(name);
+        }
+        types_.emplace(std::move(key), type);
+        return type;
+    }
+}
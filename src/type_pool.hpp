@@ -0,0 +1,76 @@
+#ifndef FRI_TYPE_POOL_HPP
+#define FRI_TYPE_POOL_HPP
+
+#include "abstract_code.hpp"
+#include "interface_names.hpp"
+
+#include <array>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace fri
+{
+    /**
+     *  @brief Creates type nodes in an arena so that structurally equal
+     *  types are created only once and shared. Types are never modified
+     *  after they are created, so they can be referred to from many places.
+     *  Each type is classified once, when it is created, e.g. as an interface
+     *  or as void, so that the generator does not need its name.
+     *
+     *  Besides that, remembers types extracted from source types, so that
+     *  a source type that was already seen is not extracted again.
+     *
+     *  Pool can be shared by threads. Types are created in its arena,
+     *  which must not be used by other threads meanwhile.
+     */
+    class TypePool
+    {
+    public:
+        TypePool (Arena& arena, InterfaceNames const& interfaces);
+
+        /**
+         *  @brief Creates pool that does not classify types,
+         *  e.g. if their classification is already known.
+         */
+        explicit TypePool (Arena& arena);
+
+        TypePool (TypePool const&) = delete;
+        auto operator= (TypePool const&) -> TypePool& = delete;
+
+        auto prim_type      (IsConst, Symbol) -> Type*;
+        auto custom_type    (IsConst, Symbol) -> Type*;
+        auto templated_type (IsConst, Type*, std::vector<TemplatedType::arg_var_t>) -> Type*;
+        auto indirection    (IsConst, Type*) -> Type*;
+        auto function       (std::vector<Type*>, Type*) -> Type*;
+        auto nested         (IsConst, Type*, Symbol) -> Type*;
+
+        /**
+         *  @brief Finds type extracted from @p source .
+         *  @return nullptr if @p source was not extracted yet.
+         */
+        auto find (void const* source, IsConst) const -> Type*;
+
+        /**
+         *  @brief Remembers that @p type was extracted from @p source .
+         */
+        auto remember (void const* source, IsConst, Type* type) -> void;
+
+    private:
+        template<class T, class... Args>
+        auto cons (std::string key, Args&&... args) -> Type*;
+
+    private:
+        using sources_t = std::unordered_map<void const*, Type*>;
+
+    private:
+        Arena*                                 arena_;
+        InterfaceNames const*                  interfaces_;
+        std::unordered_map<std::string, Type*> types_;
+        std::array<sources_t, 2>               sources_;
+        mutable std::mutex                     mutex_;
+    };
+}
+
+#endif
@@ -0,0 +1,86 @@
+#include "unit_cache.hpp"
+
+#include "flat_code.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fri
+{
+// UnitCache definitions:
+
+    UnitCache::UnitCache
+        (std::string directory) :
+        directory_ (std::move(directory))
+    {
+    }
+
+    auto UnitCache::load
+        (std::uint64_t const key) const -> std::optional<TranslationUnit>
+    {
+        auto const fd = ::open(this->entry_path(key).c_str(), O_RDONLY);
+        if (fd == -1)
+        {
+            return std::nullopt;
+        }
+
+        // The image is read in place, nodes are copied out of the mapping
+        // by expand, so it can be unmapped right after.
+        struct stat st {};
+        auto unit = std::optional<TranslationUnit>();
+        if (::fstat(fd, &st) == 0 and st.st_size > 0)
+        {
+            auto const size = static_cast<std::size_t>(st.st_size);
+            auto const data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED)
+            {
+                unit = expand(std::string_view(static_cast<char const*>(data), size));
+                ::munmap(data, size);
+            }
+        }
+        ::close(fd);
+        return unit;
+    }
+
+    auto UnitCache::store
+        (std::uint64_t const key, TranslationUnit const& unit) const -> bool
+    {
+        auto ec = std::error_code();
+        std::filesystem::create_directories(directory_, ec);
+
+        // Concurrent readers must not see a partially written unit.
+        auto const path = this->entry_path(key);
+        auto const temp = path + ".tmp";
+        auto const data = flatten(unit);
+        auto ofst = std::ofstream(temp, std::ios::binary);
+        ofst.write(data.data(), static_cast<std::streamsize>(data.size()));
+        ofst.close();
+        if (not ec and ofst)
+        {
+            std::filesystem::rename(temp, path, ec);
+        }
+
+        if (ec or not ofst)
+        {
+            std::cerr << "Failed to store translation unit: " << path << '\n';
+            return false;
+        }
+        return true;
+    }
+
+    auto UnitCache::entry_path
+        (std::uint64_t const key) const -> std::string
+    {
+        auto name = std::ostringstream();
+        name << std::hex << std::setw(16) << std::setfill('0') << key << ".unit";
+        return (std::filesystem::path(directory_) / name.str()).string();
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef FRI_UNIT_CACHE_HPP
+#define FRI_UNIT_CACHE_HPP
+
+#include "abstract_code.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace fri
+{
+    /**
+     *  @brief Flat images of translation units stored in a directory.
+     *  Units are addressed by a key that identifies their content,
+     *  e.g. a hash of the preprocessed input and extraction options.
+     */
+    class UnitCache
+    {
+    public:
+        explicit UnitCache (std::string directory);
+
+        auto load  (std::uint64_t key) const -> std::optional<TranslationUnit>;
+        auto store (std::uint64_t key, TranslationUnit const& unit) const -> bool;
+
+    private:
+        auto entry_path (std::uint64_t key) const -> std::string;
+
+    private:
+        std::string directory_;
+    };
+}
+
+#endif
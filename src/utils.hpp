@@ -1,13 +1,19 @@
 #ifndef FRI_UTILS_HPP
 #define FRI_UTILS_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
 #include <iterator>
 #include <memory>
+#include <thread>
 #include <vector>
 #include <string>
 #include <sstream>
 #include <charconv>
 #include <cassert>
+#include <cstdint>
+#include <string_view>
 
 namespace fri
 {
@@ -42,6 +48,49 @@ namespace fri
         return {ret, std::errc {} == result.ec && result.ptr == in.data() + in.size()};
     }
 
+    /**
+     *  @brief 64-bit FNV-1a hash of @p s . Passing the previous result as
+     *  @p h hashes a concatenation of multiple strings.
+     */
+    inline auto fnv1a
+        (std::string_view const s, std::uint64_t h = 14695981039346656037ull) -> std::uint64_t
+    {
+        for (auto const c : s)
+        {
+            h ^= static_cast<std::uint8_t>(c);
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    /**
+     *  @brief Calls @p process for each index in @p count on @p jobs threads.
+     *  Threads pick up the next unprocessed index as soon as they are done,
+     *  so that a few large inputs do not leave other threads idle.
+     */
+    inline auto run_parallel
+        (std::size_t const count, unsigned const jobs, std::function<void (std::size_t)> const& process) -> void
+    {
+        auto next    = std::atomic<std::size_t>(0);
+        auto workers = std::vector<std::thread>();
+        auto const workerCount = std::min<std::size_t>(jobs, count);
+        for (auto w = 0u; w < workerCount; ++w)
+        {
+            workers.emplace_back([&]()
+            {
+                for (auto i = next++; i < count; i = next++)
+                {
+                    process(i);
+                }
+            });
+        }
+
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
     template<class T>
     struct is_smart_pointer : public std::false_type
     {
@@ -0,0 +1,45 @@
+#include "watch.hpp"
+#include "file_watcher.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+namespace fri
+{
+    auto run_watch
+        ( std::string const&                                  path
+        , ExtractOptions const&                               options
+        , std::function<void (TranslationUnit const&)> const& render ) -> int
+    {
+        using steady_clock_t = std::chrono::steady_clock;
+
+        // Editors usually write a file in a few steps within a couple of milliseconds.
+        auto const settle = std::chrono::milliseconds(30);
+
+        auto parser  = IncrementalParser(std::filesystem::absolute(path).string(), options);
+        auto watcher = FileWatcher();
+        for (;;)
+        {
+            auto const start = steady_clock_t::now();
+            auto const unit  = parser.extract();
+            if (unit)
+            {
+                render(*unit);
+                auto const took = std::chrono::duration_cast<std::chrono::milliseconds>(steady_clock_t::now() - start);
+                std::cerr << "Regenerated in " << took.count() << " ms" << '\n';
+            }
+            else
+            {
+                std::cerr << "Failed to parse input file: " << path << '\n';
+            }
+
+            // Files included by the new version of the input are watched too.
+            watcher.watch(parser.files());
+            if (not watcher.wait_for_change(settle))
+            {
+                return 1;
+            }
+        }
+    }
+}
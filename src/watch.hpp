@@ -0,0 +1,22 @@
+#ifndef FRI_WATCH_HPP
+#define FRI_WATCH_HPP
+
+#include "abstract_code.hpp"
+#include "clang_source_parser.hpp"
+
+#include <functional>
+#include <string>
+
+namespace fri
+{
+    /**
+     *  @brief Extracts code from @p path and passes it to @p render each time
+     *  the input or one of the files it includes changes.
+     *  @return exit code of the program, returns only if watching fails.
+     */
+    auto run_watch ( std::string const&                                  path
+                   , ExtractOptions const&                               options
+                   , std::function<void (TranslationUnit const&)> const& render ) -> int;
+}
+
+#endif